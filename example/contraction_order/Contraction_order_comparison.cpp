@@ -0,0 +1,160 @@
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *\
+ *                                                                           *
+ *  Bundled HFK - a knot Floer homology calculator                           *
+ *                                                                           *
+ *  Copyright (C) 2021-2022  Isaac Ren                                       *
+ *  For further details, contact Isaac Ren (gopi3.1415@gmail.com).           *
+ *                                                                           *
+ *  This program is free software: you can redistribute it and/or modify     *
+ *  it under the terms of the GNU General Public License as published by     *
+ *  the Free Software Foundation, either version 3 of the License, or        *
+ *  (at your option) any later version.                                      *
+ *                                                                           *
+ *  This program is distributed in the hope that it will be useful,          *
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of           *
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the            *
+ *  GNU General Public License for more details.                             *
+ *                                                                           *
+ *  You should have received a copy of the GNU General Public License        *
+ *  along with this program.  If not, see <https://www.gnu.org/licenses/>.   *
+ *                                                                           *
+\* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+
+#include <chrono>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "Differential_suffix_forest/Differential_suffix_forest.h"
+#include "Differential_suffix_forest/Differential_suffix_forest_options.h"
+#include "Knot_diagram/Knot_diagram.h"
+#include "Math_tools/Poincare_polynomial.h"
+#include "Morse_event/Positive_crossing.h"
+#include "Morse_event/Negative_crossing.h"
+#include "Morse_event/Local_maximum.h"
+#include "Morse_event/Local_minimum.h"
+#include "Morse_event/Global_minimum.h"
+
+// Morse events allowed in CSV files
+using Knot = Knot_diagram<
+  Positive_crossing,
+  Negative_crossing,
+  Local_maximum,
+  Local_minimum,
+  Global_minimum
+>;
+
+template< class Order >
+struct Forest_options_with_order : Forest_options_default_short {
+  using Contraction_order = Order;
+};
+
+/* Compute the knot Floer homology of every knot diagram with a given
+ * contraction order, and print the fill-in of homotopy reduction. Return the
+ * Poincaré polynomials.
+ */
+template< class Order >
+std::vector< std::string > compare(
+  const std::string& name,
+  const std::vector< Knot >& knot_diagrams
+) {
+  using Forest = Differential_suffix_forest< Forest_options_with_order< Order > >;
+  
+  std::vector< std::string > pps;
+  typename Forest::Reduction_statistics statistics{};
+  auto start = std::chrono::steady_clock::now();
+  for (const Knot& knot_diagram : knot_diagrams) {
+    pps.push_back(
+      knot_diagram.knot_Floer_homology< Poincare_polynomial, Forest >(
+        statistics
+      ).to_string()
+    );
+  }
+  auto end = std::chrono::steady_clock::now();
+  
+  std::cout << "  " << name
+            << "\tcontractions " << statistics.n_contractions
+            << "\tzig-zag arcs " << statistics.n_zigzag_arcs
+            << "\treevaluations " << statistics.n_reevaluations
+            << "\ttime " << std::chrono::duration< double, std::milli >(end - start).count()
+            << " ms" << std::endl;
+  return pps;
+}
+
+/* The expected Poincaré polynomial of a CSV file, given in a comment line
+ * of the form "# Poincaré polynomial: ...". Return an empty string if there
+ * is none.
+ */
+std::string expected_polynomial(const std::string& filename) {
+  const std::string prefix = u8"# Poincar\u00E9 polynomial: ";
+  std::ifstream in_file(filename);
+  for (std::string line; std::getline(in_file, line, '\n');) {
+    if (line.compare(0, prefix.size(), prefix) == 0) {
+      return line.substr(prefix.size());
+    }
+  }
+  return "";
+}
+
+/* Print the knot diagrams whose Poincaré polynomial is not the expected one,
+ * and return whether there are none.
+ */
+bool check(
+  const std::string& name,
+  const std::vector< std::string >& pps,
+  const std::vector< std::string >& expected_pps,
+  char* filenames[]
+) {
+  bool correct = true;
+  for (int i = 0; i != pps.size(); ++i) {
+    if (!expected_pps[i].empty() and pps[i] != expected_pps[i]) {
+      std::cout << "[main] " << name << ": " << filenames[i]
+                << " gives " << pps[i] << std::endl;
+      correct = false;
+    }
+  }
+  return correct;
+}
+
+int main(int argc, char* argv[]) {
+  if (argc <= 1) {
+    std::cout << "[main] No file given! Exiting..." << std::endl;
+    return 0;
+  }
+  
+  std::vector< Knot > knot_diagrams;
+  std::vector< std::string > expected_pps;
+  for (int i = 1; i < argc; ++i) {
+    expected_pps.push_back(expected_polynomial(argv[i]));
+    std::ifstream in_file(argv[i]);
+    knot_diagrams.emplace_back();
+    knot_diagrams.back().import_csv(in_file);
+    if (knot_diagrams.back().max_n_strands() > 31) {
+      std::cout << "[main] " << argv[i] << " has too many strands. Exiting..." << std::endl;
+      return 0;
+    }
+  }
+  
+  std::cout << "[main] Fill-in of homotopy reduction for " << argc - 1
+            << " knot diagram(s)" << std::endl;
+  // Set log file, where developer messages are sent.
+  std::ofstream log_file("log.txt");
+  auto clog_buffer = std::clog.rdbuf(log_file.rdbuf());
+  
+  // All contraction orders should give the expected Poincaré polynomials
+  const auto pps = compare< Source_contraction_order >("source          ", knot_diagrams);
+  const auto fewest_neighbors_pps = compare< Fewest_neighbors_contraction_order >("fewest neighbors", knot_diagrams);
+  
+  bool agree = (fewest_neighbors_pps == pps);
+  std::cout << "[main] contraction orders "
+            << (agree ? "agree" : "disagree") << std::endl;
+  
+  bool correct = check("source", pps, expected_pps, argv + 1);
+  correct &= check("fewest neighbors", fewest_neighbors_pps, expected_pps, argv + 1);
+  std::cout << u8"[main] Poincar\u00E9 polynomials are "
+            << (correct ? "" : "not ") << "as expected" << std::endl;
+  
+  std::clog.rdbuf(clog_buffer);  // log_file is destroyed before std::clog
+  return !(agree and correct);
+}
@@ -0,0 +1 @@
+g++ -std=c++11 -O2 Contraction_order_comparison.cpp -I ../../src -o bundled-hfk-example
@@ -0,0 +1,114 @@
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *\
+ *                                                                           *
+ *  Bundled HFK - a knot Floer homology calculator                           *
+ *                                                                           *
+ *  Copyright (C) 2021-2022  Isaac Ren                                       *
+ *  For further details, contact Isaac Ren (gopi3.1415@gmail.com).           *
+ *                                                                           *
+ *  This program is free software: you can redistribute it and/or modify     *
+ *  it under the terms of the GNU General Public License as published by     *
+ *  the Free Software Foundation, either version 3 of the License, or        *
+ *  (at your option) any later version.                                      *
+ *                                                                           *
+ *  This program is distributed in the hope that it will be useful,          *
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of           *
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the            *
+ *  GNU General Public License for more details.                             *
+ *                                                                           *
+ *  You should have received a copy of the GNU General Public License        *
+ *  along with this program.  If not, see <https://www.gnu.org/licenses/>.   *
+ *                                                                           *
+\* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+
+#include <chrono>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "Differential_suffix_forest/Differential_suffix_forest.h"
+#include "Differential_suffix_forest/Differential_suffix_forest_options.h"
+#include "Knot_diagram/Knot_diagram.h"
+#include "Math_tools/Poincare_polynomial.h"
+#include "Morse_event/Positive_crossing.h"
+#include "Morse_event/Negative_crossing.h"
+#include "Morse_event/Local_maximum.h"
+#include "Morse_event/Local_minimum.h"
+#include "Morse_event/Global_minimum.h"
+
+// Morse events allowed in CSV files
+using Knot = Knot_diagram<
+  Positive_crossing,
+  Negative_crossing,
+  Local_maximum,
+  Local_minimum,
+  Global_minimum
+>;
+
+using Forest = Differential_suffix_forest< Forest_options_default_short >;
+
+/* Differential suffix forest that counts its copies, and the layers it is
+ * used for: box_tensor_product clears the new D-module once per layer.
+ */
+class Counting_forest : public Forest {
+ public:
+  Counting_forest() { }
+  
+  Counting_forest(const Counting_forest& other) : Forest(other) {
+    ++n_copies;
+  }
+  
+  Counting_forest& operator=(const Counting_forest& other) {
+    Forest::operator=(other);
+    ++n_copies;
+    return *this;
+  }
+  
+  void clear() {
+    ++n_layers;
+    Forest::clear();
+  }
+  
+  static long n_copies;
+  static long n_layers;
+};
+
+long Counting_forest::n_copies = 0;
+long Counting_forest::n_layers = 0;
+
+int main(int argc, char* argv[]) {
+  if (argc <= 1) {
+    std::cout << "[main] No file given! Exiting..." << std::endl;
+    return 0;
+  }
+  
+  std::vector< Knot > knot_diagrams;
+  for (int i = 1; i < argc; ++i) {
+    std::ifstream in_file(argv[i]);
+    knot_diagrams.emplace_back();
+    knot_diagrams.back().import_csv(in_file);
+    if (knot_diagrams.back().max_n_strands() > 31) {
+      std::cout << "[main] " << argv[i] << " has too many strands. Exiting..." << std::endl;
+      return 0;
+    }
+  }
+  
+  // Set log file, where developer messages are sent.
+  std::ofstream log_file("log.txt");
+  auto clog_buffer = std::clog.rdbuf(log_file.rdbuf());
+  
+  auto start = std::chrono::steady_clock::now();
+  for (const Knot& knot_diagram : knot_diagrams) {
+    knot_diagram.knot_Floer_homology< Poincare_polynomial, Counting_forest >();
+  }
+  auto end = std::chrono::steady_clock::now();
+  
+  std::clog.rdbuf(clog_buffer);  // log_file is destroyed before std::clog
+  
+  std::cout << "[main] " << argc - 1 << " knot diagram(s), "
+            << Counting_forest::n_layers << " layers, "
+            << Counting_forest::n_copies << " D-module copies, "
+            << std::chrono::duration< double, std::milli >(end - start).count()
+            << " ms" << std::endl;
+  return Counting_forest::n_copies != 0;
+}
@@ -0,0 +1 @@
+g++ -std=c++11 -O2 D_module_copies_benchmark.cpp -I ../../src -o bundled-hfk-example
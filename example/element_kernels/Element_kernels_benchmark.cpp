@@ -0,0 +1,221 @@
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *\
+ *                                                                           *
+ *  Bundled HFK - a knot Floer homology calculator                           *
+ *                                                                           *
+ *  Copyright (C) 2021-2022  Isaac Ren                                       *
+ *  For further details, contact Isaac Ren (gopi3.1415@gmail.com).           *
+ *                                                                           *
+ *  This program is free software: you can redistribute it and/or modify     *
+ *  it under the terms of the GNU General Public License as published by     *
+ *  the Free Software Foundation, either version 3 of the License, or        *
+ *  (at your option) any later version.                                      *
+ *                                                                           *
+ *  This program is distributed in the hope that it will be useful,          *
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of           *
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the            *
+ *  GNU General Public License for more details.                             *
+ *                                                                           *
+ *  You should have received a copy of the GNU General Public License        *
+ *  along with this program.  If not, see <https://www.gnu.org/licenses/>.   *
+ *                                                                           *
+\* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+
+#include <chrono>
+#include <cstdlib>  // atoi
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "Bordered_algebra/Bordered_algebra.h"
+#include "Bordered_algebra/Idempotent.h"
+#include "Bordered_algebra/U_weights_array.h"
+
+/* Same storage as U_weights_array, but a different type, so that algebra
+ * elements use the scalar code. This separates the effect of the kernels from
+ * the effect of the storage.
+ */
+struct Scalar_U_weights : U_weights_array< 32 > {
+  using U_weights_array< 32 >::U_weights_array;
+};
+
+using Vector_algebra = Bordered_algebra< Idempotent_short >;
+using Scalar_algebra = Bordered_algebra< Idempotent_short, Scalar_U_weights >;
+using Kernel_algebra = Bordered_algebra< Idempotent_short, U_weights_array< 32 > >;
+
+/* Random triple of idempotents (back, mid, front) with n_strands + 1 bits,
+ * such that (back, mid) and (mid, front) are close enough to form algebra
+ * elements, plus U weights for both elements.
+ */
+struct Sample {
+  std::string back, mid, front;
+  std::vector< int > back_U_weights, front_U_weights;
+};
+
+std::string close_idem(const std::string& mid, std::mt19937& gen) {
+  std::string result(mid);
+  int difference = 0;
+  for (int i = 0; i < mid.size(); ++i) {
+    int bit = gen() % 2;
+    int new_difference = difference + bit - (mid[i] - '0');
+    if (new_difference < -1 or new_difference > 1) {
+      bit = 1 - bit;
+      new_difference = difference + bit - (mid[i] - '0');
+    }
+    result[i] = '0' + bit;
+    difference = new_difference;
+  }
+  return result;
+}
+
+std::vector< Sample > make_samples(int n_samples, int n_strands, std::mt19937& gen) {
+  std::vector< Sample > samples;
+  for (int k = 0; k < n_samples; ++k) {
+    Sample sample;
+    for (int i = 0; i <= n_strands; ++i) {
+      sample.mid.push_back('0' + gen() % 2);
+    }
+    sample.back = (gen() % 4 == 0) ? sample.mid : close_idem(sample.mid, gen);
+    sample.front = (gen() % 4 == 0) ? sample.mid : close_idem(sample.mid, gen);
+    for (int i = 0; i < n_strands; ++i) {
+      sample.back_U_weights.push_back(gen() % 3 == 0 ? gen() % 4 : 0);
+      sample.front_U_weights.push_back(gen() % 3 == 0 ? gen() % 4 : 0);
+    }
+    samples.push_back(sample);
+  }
+  return samples;
+}
+
+/* Random samples whose products have the largest U weights that fit in a
+ * U_weights_array: 127 + 127, plus one where the product gains a U.
+ */
+std::vector< Sample > make_boundary_samples(int n_samples, int n_strands, std::mt19937& gen) {
+  std::vector< Sample > samples = make_samples(n_samples, n_strands, gen);
+  for (Sample& sample : samples) {
+    sample.back_U_weights.assign(n_strands, 127);
+    sample.front_U_weights.assign(n_strands, 127);
+  }
+  return samples;
+}
+
+template< class Algebra >
+struct Elements {
+  using Element = typename Algebra::Element;
+  using U_weights_type = typename Algebra::U_weights_type;
+  
+  Elements(const std::vector< Sample >& samples) {
+    for (const Sample& sample : samples) {
+      back.emplace_back(sample.back, sample.mid, convert(sample.back_U_weights));
+      front.emplace_back(sample.mid, sample.front, convert(sample.front_U_weights));
+    }
+  }
+  
+  static U_weights_type convert(const std::vector< int >& U_weights) {
+    U_weights_type result(U_weights.size(), 0);
+    for (int i = 0; i < U_weights.size(); ++i) {
+      result[i] = U_weights[i];
+    }
+    return result;
+  }
+  
+  std::vector< Element > back;
+  std::vector< Element > front;
+};
+
+template< class Element >
+std::vector< int > U_weights_of(const Element& element) {
+  return std::vector< int >(element.U_weights().begin(), element.U_weights().end());
+}
+
+/* Time a function over all samples, in nanoseconds per call. The checksum
+ * prevents the compiler from removing the calls.
+ */
+template< class Function >
+double time_ns(int n_rounds, int n_samples, Function f, long& checksum) {
+  auto start = std::chrono::steady_clock::now();
+  for (int round = 0; round < n_rounds; ++round) {
+    for (int k = 0; k < n_samples; ++k) {
+      checksum += f(k);
+    }
+  }
+  auto end = std::chrono::steady_clock::now();
+  return std::chrono::duration< double, std::nano >(end - start).count()
+         / (double(n_rounds) * n_samples);
+}
+
+template< class Algebra >
+void benchmark(const std::string& name, const std::vector< Sample >& samples, int n_rounds) {
+  Elements< Algebra > elements(samples);
+  const int n = samples.size();
+  long checksum = 0;
+  double product = time_ns(n_rounds, n, [&](int k) {
+    return (elements.back[k] * elements.front[k]).U_weight(0);
+  }, checksum);
+  double is_null = time_ns(n_rounds, n, [&](int k) {
+    return elements.back[k].is_null();
+  }, checksum);
+  double is_invertible = time_ns(n_rounds, n, [&](int k) {
+    return elements.back[k].is_invertible();
+  }, checksum);
+  std::cout << "  " << name
+            << "\tproduct " << product << " ns"
+            << "\tis_null " << is_null << " ns"
+            << "\tis_invertible " << is_invertible << " ns"
+            << "\t(checksum " << checksum << ")" << std::endl;
+}
+
+/* Compare an algebra with U weights in a U_weights_array, for instance one
+ * using the kernels, with the scalar code on std::vector on every sample.
+ */
+template< class Algebra >
+int check(const std::vector< Sample >& samples) {
+  Elements< Vector_algebra > reference(samples);
+  Elements< Algebra > kernels(samples);
+  int n_errors = 0;
+  for (int k = 0; k < samples.size(); ++k) {
+    auto reference_product = reference.back[k] * reference.front[k];
+    auto kernel_product = kernels.back[k] * kernels.front[k];
+    if (
+      U_weights_of(reference_product) != U_weights_of(kernel_product)
+      or reference.back[k].is_null() != kernels.back[k].is_null()
+      or reference.front[k].is_null() != kernels.front[k].is_null()
+      or reference.back[k].is_invertible() != kernels.back[k].is_invertible()
+    ) {
+      ++n_errors;
+    }
+  }
+  return n_errors;
+}
+
+int main(int argc, char* argv[]) {
+  const int n_samples = 100000;
+  const int n_rounds = (argc > 1) ? std::atoi(argv[1]) : 20;
+  std::mt19937 gen(0);
+  
+  int n_errors = 0;
+  for (int n_strands : {1, 2, 3, 8, 16, 30}) {
+    n_errors += check< Kernel_algebra >(make_samples(n_samples, n_strands, gen));
+  }
+  std::cout << "[main] kernels disagree with scalar code on "
+            << n_errors << " samples" << std::endl;
+  
+  int n_boundary_errors = 0;
+  for (int n_strands : {1, 8, 30}) {
+    const std::vector< Sample > samples = make_boundary_samples(n_samples, n_strands, gen);
+    n_boundary_errors += check< Scalar_algebra >(samples);
+    n_boundary_errors += check< Kernel_algebra >(samples);
+  }
+  std::cout << "[main] U weights up to 255 are wrong on "
+            << n_boundary_errors << " samples" << std::endl;
+  n_errors += n_boundary_errors;
+  
+  for (int n_strands : {8, 16, 30}) {
+    std::vector< Sample > samples = make_samples(n_samples, n_strands, gen);
+    std::cout << "[main] " << n_strands << " strands" << std::endl;
+    benchmark< Vector_algebra >("vector, scalar", samples, n_rounds);
+    benchmark< Scalar_algebra >("array, scalar ", samples, n_rounds);
+    benchmark< Kernel_algebra >("array, kernels", samples, n_rounds);
+  }
+  
+  return n_errors != 0;
+}
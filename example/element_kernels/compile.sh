@@ -0,0 +1 @@
+g++ -std=c++11 -O2 Element_kernels_benchmark.cpp -I ../../src -o bundled-hfk-example
\ No newline at end of file
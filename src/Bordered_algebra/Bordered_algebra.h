@@ -24,9 +24,17 @@
 #define BORDERED_ALGEBRA_H_
 
 #include <algorithm>  // none_of
+#include <cassert>
+#include <cstddef>  // size_t
 #include <iostream>
+#include <limits>  // numeric_limits
+#include <type_traits>  // integral_constant
 #include <vector>
 
+#include <boost/functional/hash.hpp>  // hash_combine
+
+#include "Element_kernels.h"
+
 /* Bordered algebra.
  * 
  * Implementation of bordered algebras for bordered knot Floer homology.
@@ -38,10 +46,15 @@
  * This struct has a member class, Element, which implements algebra elements.
  * The implementation of bordered algebras does not depend on the implementation
  * of the idempotent ring. However, the implementation of algebra elements does.
+ * 
+ * The second template parameter is the container of U weights of algebra
+ * elements. It behaves like std::vector< int >, possibly with a fixed capacity
+ * (see U_weights_array.h).
  */
-template< class Idempotent >
+template< class Idempotent, class U_weight_container = std::vector< int > >
 struct Bordered_algebra {
   using Idem = Idempotent;
+  using U_weights_type = U_weight_container;
   
   int n_strands;  // size of matchings and orientations, for convenience
   
@@ -58,7 +71,7 @@ struct Bordered_algebra {
    */
   class Element {
    public:
-    Element(Idem source_idem, Idem target_idem, std::vector< int > U_weights) :
+    Element(Idem source_idem, Idem target_idem, const U_weights_type& U_weights) :
       source_idem_(source_idem),
       target_idem_(target_idem),
       U_weights_(U_weights)
@@ -78,7 +91,7 @@ struct Bordered_algebra {
       return target_idem_;
     }
     
-    std::vector< int > U_weights() const {
+    const U_weights_type& U_weights() const {
       return U_weights_;
     }
     
@@ -90,7 +103,7 @@ struct Bordered_algebra {
       return U_weights_[position];
     }
     
-    int& U_weight(int position) {
+    typename U_weights_type::reference U_weight(int position) {
       return U_weights_[position];
     }
     
@@ -98,24 +111,7 @@ struct Bordered_algebra {
      * This only produces a defined result if the real product is nonzero.
      */
     Element operator*(const Element& other) const {
-      std::vector< int > product_U_weights(U_weights_);
-      int back_weight = 0;
-      int mid_weight = 0;
-      int front_weight = 0;
-      
-      for (int i = 0; i < product_U_weights.size(); ++i) {
-        if (source_idem_[i]) { ++back_weight; }
-        if (target_idem_[i]) { ++mid_weight; }
-        if (other.target_idem_[i]) { ++front_weight; }
-        if ((back_weight > mid_weight and mid_weight < front_weight)
-            or (back_weight < mid_weight and mid_weight > front_weight)) {
-          product_U_weights[i] += other.U_weights_[i] + 1;  // L_iR_i = U_i = R_iL_i
-        }
-        else {
-          product_U_weights[i] += other.U_weights_[i];
-        }
-      }
-      return Element(source_idem_, other.target_idem_, product_U_weights);
+      return multiply_(other, Word_parallel());
     }  // operator*
     
     bool operator==(const Element& other) const {
@@ -123,6 +119,16 @@ struct Bordered_algebra {
               and U_weights_ == other.U_weights_);
     }
     
+    /* Hash value, compatible with operator==. */
+    std::size_t hash() const {
+      std::size_t seed = source_idem_.hash();
+      boost::hash_combine(seed, target_idem_.hash());
+      for (int U_weight : U_weights_) {
+        boost::hash_combine(seed, U_weight);
+      }
+      return seed;
+    }
+    
     /* is_null. Taken from ComputeHFKv2/Utility.cpp, NonZero
      * 
      * Pre-condition: source and target idems are close enough.
@@ -131,44 +137,11 @@ struct Bordered_algebra {
      * described in [OzsvathSzabo2018, Definition 3.6].
      */
     bool is_null() const {
-      bool interval(true);  // flag indicating that we have started an interval
-      bool LR_i(false);     // flag indicating that the algebra element has an L_i or R_i
-      bool U_i;             // flag indicating that the algebra element has a U_i
-      bool source_i;  // i^th bit of the source idem
-      bool target_i;  // i^th bit of the target idem
-      
-      for (int i = 0; i < U_weights_.size(); ++i) {
-        U_i = U_weights_[i];
-        source_i = source_idem_[i + 1];
-        target_i = target_idem_[i + 1];
-        
-        if (interval and (!source_i or !target_i) and U_i) {  // end of interval
-          return true;
-        }
-        else if ((LR_i and (source_i != target_i))
-                 or (!LR_i and !source_i and !target_i)) {  // start of interval
-          interval = true;
-        } 
-        else if (interval and !LR_i and source_i and target_i and U_i) {  // continue the interval
-          //interval = true;  // We don't actually need this instruction
-        }
-        else {  // reset the interval flag
-          interval = false;
-        }
-        LR_i = (LR_i != (source_i != target_i));
-      }
-      return false;
+      return is_null_(Word_parallel());
     }  // is null
     
     bool is_invertible() const {
-      return (
-        (source_idem_ == target_idem_)
-        and std::none_of(
-          U_weights_.begin(),
-          U_weights_.end(),
-          [](int n) { return n; }
-        )
-      );
+      return (source_idem_ == target_idem_) and no_U_weights_(Word_parallel());
     }
     
     /* Produce the algebra element associated to the differential cell, in LaTeX
@@ -212,16 +185,100 @@ struct Bordered_algebra {
       return LRU_string;
     }  // to_string
     
-    friend std::ostream& operator<<(std::ostream& os, const typename Bordered_algebra< Idempotent >::Element& el) {
+    friend std::ostream& operator<<(std::ostream& os, const Element& el) {
       os << el.to_string();
       return os;
     }
     
    private:
+    using Kernels = Element_kernels< Idem, U_weights_type >;
+    using Word_parallel = std::integral_constant< bool, Kernels::word_parallel >;
+    
+    /* Scalar and word-parallel versions of the product, is_null and
+     * is_invertible. See Element_kernels.h for the word-parallel versions.
+     */
+    Element multiply_(const Element& other, std::false_type) const {
+      U_weights_type product_U_weights(U_weights_);
+      int back_weight = 0;
+      int mid_weight = 0;
+      int front_weight = 0;
+      
+      for (int i = 0; i < product_U_weights.size(); ++i) {
+        if (source_idem_[i]) { ++back_weight; }
+        if (target_idem_[i]) { ++mid_weight; }
+        if (other.target_idem_[i]) { ++front_weight; }
+        int U_weight = product_U_weights[i] + other.U_weights_[i];
+        if ((back_weight > mid_weight and mid_weight < front_weight)
+            or (back_weight < mid_weight and mid_weight > front_weight)) {
+          ++U_weight;  // L_iR_i = U_i = R_iL_i
+        }
+        assert(U_weight <= std::numeric_limits< typename U_weights_type::value_type >::max());
+        product_U_weights[i] = U_weight;
+      }
+      return Element(source_idem_, other.target_idem_, product_U_weights);
+    }
+    
+    Element multiply_(const Element& other, std::true_type) const {
+      U_weights_type product_U_weights;
+      Kernels::add(
+        U_weights_,
+        other.U_weights_,
+        Kernels::product_gains(source_idem_, target_idem_, other.target_idem_, U_weights_.size()),
+        product_U_weights
+      );
+      return Element(source_idem_, other.target_idem_, product_U_weights);
+    }
+    
+    bool is_null_(std::false_type) const {
+      bool interval(true);  // flag indicating that we have started an interval
+      bool LR_i(false);     // flag indicating that the algebra element has an L_i or R_i
+      bool U_i;             // flag indicating that the algebra element has a U_i
+      bool source_i;  // i^th bit of the source idem
+      bool target_i;  // i^th bit of the target idem
+      
+      for (int i = 0; i < U_weights_.size(); ++i) {
+        U_i = U_weights_[i];
+        source_i = source_idem_[i + 1];
+        target_i = target_idem_[i + 1];
+        
+        if (interval and (!source_i or !target_i) and U_i) {  // end of interval
+          return true;
+        }
+        else if ((LR_i and (source_i != target_i))
+                 or (!LR_i and !source_i and !target_i)) {  // start of interval
+          interval = true;
+        } 
+        else if (interval and !LR_i and source_i and target_i and U_i) {  // continue the interval
+          //interval = true;  // We don't actually need this instruction
+        }
+        else {  // reset the interval flag
+          interval = false;
+        }
+        LR_i = (LR_i != (source_i != target_i));
+      }
+      return false;
+    }
+    
+    bool is_null_(std::true_type) const {
+      return Kernels::is_null(source_idem_, target_idem_, U_weights_);
+    }
+    
+    bool no_U_weights_(std::false_type) const {
+      return std::none_of(
+        U_weights_.begin(),
+        U_weights_.end(),
+        [](int n) { return n; }
+      );
+    }
+    
+    bool no_U_weights_(std::true_type) const {
+      return Kernels::all_zero(U_weights_);
+    }
+    
     Idem source_idem_;
     Idem target_idem_;
     
-    std::vector< int > U_weights_;
+    U_weights_type U_weights_;
   };  // Element
 };  // Bordered_algebra
 
@@ -0,0 +1,201 @@
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *\
+ *                                                                           *
+ *  Bundled HFK - a knot Floer homology calculator                           *
+ *                                                                           *
+ *  Copyright (C) 2021-2022  Isaac Ren                                       *
+ *  For further details, contact Isaac Ren (gopi3.1415@gmail.com).           *
+ *                                                                           *
+ *  This program is free software: you can redistribute it and/or modify     *
+ *  it under the terms of the GNU General Public License as published by     *
+ *  the Free Software Foundation, either version 3 of the License, or        *
+ *  (at your option) any later version.                                      *
+ *                                                                           *
+ *  This program is distributed in the hope that it will be useful,          *
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of           *
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the            *
+ *  GNU General Public License for more details.                             *
+ *                                                                           *
+ *  You should have received a copy of the GNU General Public License        *
+ *  along with this program.  If not, see <https://www.gnu.org/licenses/>.   *
+ *                                                                           *
+\* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+
+#ifndef ELEMENT_KERNELS_H_
+#define ELEMENT_KERNELS_H_
+
+#include <cassert>
+#include <cstdint>  // uint64_t
+
+#include "Idempotent.h"
+#include "U_weights_array.h"
+
+/* Word-parallel kernels for bordered algebra elements.
+ * 
+ * Bordered_algebra::Element uses these kernels instead of its strand-by-strand
+ * loops whenever word_parallel is true, that is, when idempotents and U
+ * weights are stored in machine words: Idempotent_short and U_weights_array.
+ * For other representations, the element falls back to the scalar code.
+ * 
+ * Idempotents and U weights are handled as bit masks, where bit i corresponds
+ * to strand i. All masks are computed for every strand at once, and bits past
+ * the number of strands are discarded at the end.
+ */
+template< class Idem, class U_weights_type >
+struct Element_kernels {
+  static constexpr bool word_parallel = false;
+};
+
+template< int Max_size >
+struct Element_kernels< Idempotent_short, U_weights_array< Max_size > > {
+  static constexpr bool word_parallel = true;
+  
+  using U_weights_type = U_weights_array< Max_size >;
+  using Mask = std::uint64_t;
+  
+  static_assert(Max_size <= 64, "U weights do not fit in a mask");
+  
+  /* Mask of the positions that gain a U in the product of (back, mid) and
+   * (mid, front). See Element::operator*: position i gains a U if the number
+   * of occupied strands up to i in the middle idempotent is strictly smaller
+   * than or strictly greater than in both outer idempotents.
+   */
+  static Mask product_gains(
+    const Idempotent_short& back,
+    const Idempotent_short& mid,
+    const Idempotent_short& front,
+    int size
+  ) {
+    Mask back_ahead, back_behind, front_ahead, front_behind;
+    compare_prefixes_(bits_(back), bits_(mid), back_ahead, back_behind);
+    compare_prefixes_(bits_(front), bits_(mid), front_ahead, front_behind);
+    return ((back_ahead & front_ahead) | (back_behind & front_behind)) & low_mask_(size);
+  }
+  
+  /* Lane-wise sum of U weights, plus one for each gain. Words are added
+   * whole, so a sum greater than 255 would carry into the next lane: this is
+   * checked by an assertion.
+   */
+  static void add(
+    const U_weights_type& back_U_weights,
+    const U_weights_type& front_U_weights,
+    Mask gains,
+    U_weights_type& result
+  ) {
+    result = back_U_weights;
+    for (int w = 0; w < U_weights_type::n_words; ++w) {
+      const std::uint64_t front_word = front_U_weights.words()[w];
+      const std::uint64_t gain_word = spread_(gains >> (8 * w));
+      assert(!carries_(result.words()[w], front_word)
+             and !carries_(result.words()[w] + front_word, gain_word));
+      result.words()[w] += front_word + gain_word;
+    }
+  }
+  
+  /* Mask of the nonzero U weights. */
+  static Mask nonzero(const U_weights_type& U_weights) {
+    Mask result = 0;
+    for (int w = 0; w < U_weights_type::n_words; ++w) {
+      result |= gather_(U_weights.words()[w]) << (8 * w);
+    }
+    return result;
+  }
+  
+  static bool all_zero(const U_weights_type& U_weights) {
+    Mask result = 0;
+    for (int w = 0; w < U_weights_type::n_words; ++w) {
+      result |= U_weights.words()[w];
+    }
+    return result == 0;
+  }
+  
+  /* Generating interval test, equivalent to the state machine of the scalar
+   * Element::is_null. With s, t the source and target bits shifted by one,
+   * and LR the parity of differing bits strictly before i:
+   * - an interval starts after i if (LR and s != t) or (!LR and !s and !t);
+   * - an interval continues after i if !LR and s and t and U_i;
+   * - an interval started at position -1.
+   * The element is null if an interval reaches a position where (!s or !t)
+   * and U_i. Intervals are flooded with a parallel prefix computation.
+   */
+  static bool is_null(
+    const Idempotent_short& source_idem,
+    const Idempotent_short& target_idem,
+    const U_weights_type& U_weights
+  ) {
+    const Mask source = bits_(source_idem) >> 1;
+    const Mask target = bits_(target_idem) >> 1;
+    const Mask U = nonzero(U_weights);
+    const Mask differ = source ^ target;
+    const Mask LR = prefix_xor_(differ) << 1;
+    
+    const Mask starts = (LR & differ) | (~LR & ~source & ~target);
+    const Mask continues = ~LR & source & target & U;
+    
+    Mask interval = (starts << 1) | 1;
+    Mask propagate = continues << 1;
+    for (int shift = 1; shift < 64; shift <<= 1) {
+      interval |= propagate & (interval << shift);
+      propagate &= propagate << shift;
+    }
+    
+    const Mask ends = (~source | ~target) & U;
+    return (interval & ends & low_mask_(U_weights.size())) != 0;
+  }
+ 
+ private:
+  static Mask bits_(const Idempotent_short& idem) {
+    return static_cast< Mask >(idem.bits());
+  }
+  
+  static Mask low_mask_(int size) {
+    return size >= 64 ? ~Mask(0) : (Mask(1) << size) - 1;
+  }
+  
+  /* Bit i is the parity of bits 0 to i. */
+  static Mask prefix_xor_(Mask x) {
+    for (int shift = 1; shift < 64; shift <<= 1) {
+      x ^= x << shift;
+    }
+    return x;
+  }
+  
+  /* Positions where the number of 1 bits up to i is greater (ahead) or
+   * smaller (behind) in x than in y. These differ by at most one, so they
+   * differ exactly on runs opened and closed by bits where x != y. A run is
+   * ahead if its opening bit is in x. Adding the opening bits of the runs
+   * ahead clears these runs.
+   */
+  static void compare_prefixes_(Mask x, Mask y, Mask& ahead, Mask& behind) {
+    const Mask open = prefix_xor_(x ^ y);
+    ahead = open & ~(open + (x & ~y & open));
+    behind = open & ~ahead;
+  }
+  
+  /* Bits 0 to 7 of a mask, as the lowest bits of 8 byte lanes. */
+  static std::uint64_t spread_(Mask mask) {
+    std::uint64_t x = mask & 0xff;
+    x = (x | (x << 28)) & 0x0000000f0000000fULL;
+    x = (x | (x << 14)) & 0x0003000300030003ULL;
+    x = (x | (x << 7)) & 0x0101010101010101ULL;
+    return x;
+  }
+  
+  /* Whether the lane-wise sum of two words carries out of some byte lane.
+   * The sum of the low 7 bits of each lane does not carry, and the carry out
+   * of bit 7 is the majority of bit 7 of x, y and the carry into bit 7.
+   */
+  static bool carries_(std::uint64_t x, std::uint64_t y) {
+    const std::uint64_t high_bits = 0x8080808080808080ULL;
+    const std::uint64_t sum = ((x & ~high_bits) + (y & ~high_bits)) ^ ((x ^ y) & high_bits);
+    return (((x & y) | ((x | y) & ~sum)) & high_bits) != 0;
+  }
+  
+  /* One bit per nonzero byte lane. */
+  static Mask gather_(std::uint64_t word) {
+    const std::uint64_t low_bits = 0x7f7f7f7f7f7f7f7fULL;
+    const std::uint64_t high_bits = (word | ((word & low_bits) + low_bits)) & ~low_bits;
+    return ((high_bits >> 7) * 0x0102040810204080ULL) >> 56;
+  }
+};
+
+#endif  // ELEMENT_KERNELS_H_
@@ -23,7 +23,11 @@
 #ifndef IDEMPOTENT_H_
 #define IDEMPOTENT_H_
 
+#include <algorithm>  // max
+#include <bitset>
+#include <cstddef>  // size_t
 #include <cstdint>  // int_fast32_t, I think
+#include <functional>  // hash
 #include <iostream>
 #include <initializer_list>
 #include <string>
@@ -103,6 +107,17 @@ class Idempotent_short {
     return actual_size_;
   }
   
+  /* Raw bits, for word-parallel computations. Bit i is the i^th value. */
+  Idempotent_short_type bits() const {
+    return data_;
+  }
+  
+  /* Number of values equal to 1 among the first n values, by a popcount. */
+  int count(int n) const {
+    const unsigned long long mask = (1ULL << n) - 1;
+    return std::bitset< 64 >(static_cast< unsigned long long >(data_) & mask).count();
+  }
+  
   void flip(int i) {
     data_ = data_ ^ (1 << i);
   }
@@ -158,6 +173,11 @@ class Idempotent_short {
     std::swap(actual_size_, other.actual_size_);
   }
   
+  /* Hash value, compatible with operator==. */
+  std::size_t hash() const {
+    return std::hash< Idempotent_short_type >()(data_);
+  }
+  
   /* Convert the idempotent to a string, for display and debugging purposes.
    */
   std::string to_string() const {
@@ -220,8 +240,19 @@ class Idempotent_long {
     return (data_ != other.data_);
   }
   
+  /* Compare two idempotents in the same order as Idempotent_short, that is,
+   * lexicographically from the last value, so that forests order their roots
+   * in the same way with both types of idempotents.
+   */
   bool operator <(const Idempotent_long& other) const {
-    return (data_ < other.data_);
+    for (int i = static_cast< int >(std::max(data_.size(), other.data_.size())) - 1; i >= 0; --i) {
+      const bool value = i < data_.size() and data_[i];
+      const bool other_value = i < other.data_.size() and other.data_[i];
+      if (value != other_value) {
+        return other_value;
+      }
+    }
+    return false;
   }
   
   bool operator[](int i) const {
@@ -232,21 +263,30 @@ class Idempotent_long {
     return data_.size();
   }
   
+  /* Number of values equal to 1 among the first n values. */
+  int count(int n) const {
+    int result = 0;
+    for (int i = 0; i < n; ++i) {
+      result += data_[i];
+    }
+    return result;
+  }
+  
   /* flip an individual bit
    * Note that there may exist a function flip() which takes no arguments and
    * flips every value.
    */
   void flip(int i) {
-    data_[i] = ~data_[i];
+    data_[i] = !data_[i];
   }
   
   /* Insert boolean values right before pos */
   void insert(int pos, std::initializer_list< bool > ilist) {
-    data_.insert(data_.begin(), ilist);
+    data_.insert(data_.begin() + pos, ilist);
   }
   
   void erase(int pos, int n_erase) {
-    data_.erase(data_.begin() + pos, data_.begin() + pos + n_erase - 1);
+    data_.erase(data_.begin() + pos, data_.begin() + pos + n_erase);
   }
   
   bool too_far_from(Idempotent_long other) const {
@@ -273,6 +313,11 @@ class Idempotent_long {
     data_.swap(other.data_);
   }
   
+  /* Hash value, compatible with operator==. */
+  std::size_t hash() const {
+    return std::hash< Bit_container >()(data_);
+  }
+  
   /* Convert the idempotent to a string, for display and debugging purposes.
    */  
   std::string to_string() const {
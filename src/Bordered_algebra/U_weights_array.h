@@ -0,0 +1,174 @@
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *\
+ *                                                                           *
+ *  Bundled HFK - a knot Floer homology calculator                           *
+ *                                                                           *
+ *  Copyright (C) 2021-2022  Isaac Ren                                       *
+ *  For further details, contact Isaac Ren (gopi3.1415@gmail.com).           *
+ *                                                                           *
+ *  This program is free software: you can redistribute it and/or modify     *
+ *  it under the terms of the GNU General Public License as published by     *
+ *  the Free Software Foundation, either version 3 of the License, or        *
+ *  (at your option) any later version.                                      *
+ *                                                                           *
+ *  This program is distributed in the hope that it will be useful,          *
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of           *
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the            *
+ *  GNU General Public License for more details.                             *
+ *                                                                           *
+ *  You should have received a copy of the GNU General Public License        *
+ *  along with this program.  If not, see <https://www.gnu.org/licenses/>.   *
+ *                                                                           *
+\* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+
+#ifndef U_WEIGHTS_ARRAY_H_
+#define U_WEIGHTS_ARRAY_H_
+
+#include <algorithm>  // all_of, copy, copy_backward, equal, fill
+#include <cassert>
+#include <cstddef>  // size_t
+#include <cstdint>  // uint8_t, uint64_t
+#include <initializer_list>
+
+// words() and the word-parallel kernels of Element_kernels.h assume that lane
+// i is the low byte i % 8 of word i / 8.
+#if defined(__BYTE_ORDER__) and __BYTE_ORDER__ != __ORDER_LITTLE_ENDIAN__
+#error "U_weights_array requires a little-endian byte order"
+#endif
+
+/* U_weights_array.
+ * 
+ * Fixed-capacity replacement for std::vector< int > as the container of U
+ * weights of a bordered algebra element. Weights are stored inline as 8-bit
+ * lanes, packed in machine words, so copying an algebra element never
+ * allocates. The template parameter is the maximum number of strands.
+ * 
+ * Only the part of the std::vector interface used by algebra elements and
+ * Morse events is provided. Weights must lie between 0 and max_value = 255:
+ * this is far more than what appears in knots we can compute in practice.
+ * Larger weights are not saturated but wrap around: constructors and
+ * products of algebra elements check the bound with assertions.
+ */
+template< int Max_size >
+class U_weights_array {
+ public:
+  using value_type = std::uint8_t;
+  using reference = std::uint8_t&;
+  using const_reference = const std::uint8_t&;
+  using iterator = std::uint8_t*;
+  using const_iterator = const std::uint8_t*;
+  
+  static constexpr int n_words = (Max_size + 7) / 8;
+  static constexpr int max_value = 255;
+  
+  U_weights_array() : size_(0) {
+    std::fill(words_, words_ + n_words, 0);
+  }
+  
+  U_weights_array(std::size_t n, int value) : size_(n) {
+    assert(n <= Max_size);
+    assert(0 <= value and value <= max_value);
+    std::fill(words_, words_ + n_words, 0);
+    std::fill(begin(), end(), value);
+  }
+  
+  U_weights_array(std::initializer_list< int > ilist) : size_(ilist.size()) {
+    assert(ilist.size() <= Max_size);
+    assert(std::all_of(ilist.begin(), ilist.end(), in_range_));
+    std::fill(words_, words_ + n_words, 0);
+    std::copy(ilist.begin(), ilist.end(), begin());
+  }
+  
+  std::size_t size() const {
+    return size_;
+  }
+  
+  bool empty() const {
+    return size_ == 0;
+  }
+  
+  reference operator[](int i) {
+    return lanes_()[i];
+  }
+  
+  const_reference operator[](int i) const {
+    return lanes_()[i];
+  }
+  
+  iterator begin() {
+    return lanes_();
+  }
+  
+  iterator end() {
+    return lanes_() + size_;
+  }
+  
+  const_iterator begin() const {
+    return lanes_();
+  }
+  
+  const_iterator end() const {
+    return lanes_() + size_;
+  }
+  
+  /* Lanes past the size are always 0, so that whole words can be compared
+   * and used in word-parallel computations. Lane i is byte i % 8 of word
+   * i / 8, counted from the low byte: this only holds on little-endian
+   * machines, which is checked at compile time when the compiler gives the
+   * byte order. Writing to the words directly must keep lanes past the size
+   * at 0.
+   */
+  const std::uint64_t* words() const {
+    return words_;
+  }
+  
+  std::uint64_t* words() {
+    return words_;
+  }
+  
+  /* Insert values right before pos. */
+  iterator insert(const_iterator pos, std::initializer_list< int > ilist) {
+    assert(size_ + ilist.size() <= Max_size);
+    assert(std::all_of(ilist.begin(), ilist.end(), in_range_));
+    iterator first = begin() + (pos - begin());
+    std::copy_backward(first, end(), end() + ilist.size());
+    std::copy(ilist.begin(), ilist.end(), first);
+    size_ += ilist.size();
+    return first;
+  }
+  
+  /* Erase values from first to last - 1. */
+  iterator erase(const_iterator first, const_iterator last) {
+    iterator new_first = begin() + (first - begin());
+    iterator new_last = begin() + (last - begin());
+    iterator new_end = std::copy(new_last, end(), new_first);
+    std::fill(new_end, end(), 0);
+    size_ = new_end - begin();
+    return new_first;
+  }
+  
+  bool operator==(const U_weights_array& other) const {
+    return size_ == other.size_ and std::equal(words_, words_ + n_words, other.words_);
+  }
+  
+  bool operator!=(const U_weights_array& other) const {
+    return !(*this == other);
+  }
+ 
+ private:
+  static bool in_range_(int value) {
+    return 0 <= value and value <= max_value;
+  }
+  
+  std::uint8_t* lanes_() {
+    return reinterpret_cast< std::uint8_t* >(words_);
+  }
+  
+  const std::uint8_t* lanes_() const {
+    return reinterpret_cast< const std::uint8_t* >(words_);
+  }
+  
+  std::uint64_t words_[n_words];
+  std::size_t size_;
+};
+
+#endif  // U_WEIGHTS_ARRAY_H_
@@ -0,0 +1,129 @@
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *\
+ *                                                                           *
+ *  Bundled HFK - a knot Floer homology calculator                           *
+ *                                                                           *
+ *  Copyright (C) 2021-2022  Isaac Ren                                       *
+ *  For further details, contact Isaac Ren (gopi3.1415@gmail.com).           *
+ *                                                                           *
+ *  This program is free software: you can redistribute it and/or modify     *
+ *  it under the terms of the GNU General Public License as published by     *
+ *  the Free Software Foundation, either version 3 of the License, or        *
+ *  (at your option) any later version.                                      *
+ *                                                                           *
+ *  This program is distributed in the hope that it will be useful,          *
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of           *
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the            *
+ *  GNU General Public License for more details.                             *
+ *                                                                           *
+ *  You should have received a copy of the GNU General Public License        *
+ *  along with this program.  If not, see <https://www.gnu.org/licenses/>.   *
+ *                                                                           *
+\* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+
+#ifndef ALG_EL_STORAGE_H_
+#define ALG_EL_STORAGE_H_
+
+#include <cstddef>  // size_t
+#include <cstdint>  // uint32_t
+#include <deque>
+#include <iostream>
+#include <unordered_map>
+
+/* Algebra element storage policies.
+ * 
+ * An algebra element storage policy tells Arc_container what an arc holds as
+ * its value. It provides a pool template, with:
+ * - a Value type, stored in arcs, where equal values mean equal elements;
+ * - intern(), turning an algebra element into a value;
+ * - value(), turning a value back into an algebra element;
+ * - hash(), a hash of a value, compatible with equality of values.
+ * Each forest owns one pool, so values should not be passed from one forest
+ * to another.
+ */
+
+/* Arcs hold algebra elements directly. The pool does nothing. */
+struct Direct_alg_el_storage {
+  template< class Alg_el >
+  class Pool {
+   public:
+    using Value = Alg_el;
+    
+    Value intern(const Alg_el& alg_el) const {
+      return alg_el;
+    }
+    
+    const Alg_el& value(const Value& value) const {
+      return value;
+    }
+    
+    std::size_t hash(const Value& value) const {
+      return value.hash();
+    }
+    
+    void clear() { }
+  };
+};
+
+/* Arcs hold 32-bit identifiers of hash-consed algebra elements. Comparing
+ * values becomes an integer comparison, and arcs have a fixed size.
+ * 
+ * Elements are never removed from the pool, but a forest only lives for one
+ * layer of the knot diagram.
+ */
+struct Interned_alg_el_storage {
+  struct Alg_el_id {
+    std::uint32_t id;
+    
+    bool operator==(const Alg_el_id& other) const {
+      return id == other.id;
+    }
+    
+    bool operator!=(const Alg_el_id& other) const {
+      return id != other.id;
+    }
+    
+    friend std::ostream& operator<<(std::ostream& os, const Alg_el_id& value) {
+      os << "#" << value.id;
+      return os;
+    }
+  };
+  
+  template< class Alg_el >
+  class Pool {
+   public:
+    using Value = Alg_el_id;
+    
+    Value intern(const Alg_el& alg_el) {
+      auto result = ids_.emplace(alg_el, Value{ (std::uint32_t)alg_els_.size() });
+      if (result.second) {
+        alg_els_.push_back(alg_el);
+      }
+      return result.first->second;
+    }
+    
+    const Alg_el& value(const Value& value) const {
+      return alg_els_[value.id];
+    }
+    
+    std::size_t hash(const Value& value) const {
+      return value.id;
+    }
+    
+    void clear() {
+      alg_els_.clear();
+      ids_.clear();
+    }
+   
+   private:
+    struct Alg_el_hash {
+      std::size_t operator()(const Alg_el& alg_el) const {
+        return alg_el.hash();
+      }
+    };
+    
+    std::deque< Alg_el > alg_els_;  // stable references when interning
+    std::unordered_map< Alg_el, Value, Alg_el_hash > ids_;
+  };
+};
+
+#endif  // ALG_EL_STORAGE_H_
@@ -23,24 +23,26 @@
 #ifndef ARC_CONTAINER_H_
 #define ARC_CONTAINER_H_
 
+#include <algorithm>  // lower_bound, max, min, sort, stable_sort, unique, upper_bound
+#include <cstddef>  // size_t
 #include <iostream>
+#include <iterator>  // next
+#include <tuple>  // tie
 #include <vector>
 
-#include <boost/multi_index_container.hpp>
-#include <boost/multi_index/ordered_index.hpp>
-#include <boost/multi_index/member.hpp>
-
 #include "Differential_suffix_forest_options.h"
 #include "Node_container.h"
+#include "Utility/Parallel_for.h"
 
 /* Arc container.
  * 
  * Arcs correspond to coefficient bundles (see explanation at
  * Differential_suffix_forest).
  * 
- * Arcs are stored in a boost multi-index container, indexed by source and
- * target nodes. Thus, we can iterate over arcs in order of source or target.
- * This is useful for finding neighbors without too much overhead (maybe).
+ * Arcs are stored in a container indexed by source and target nodes, given by
+ * the arc storage policy of the forest options (see Arc_storage.h). Thus, we
+ * can iterate over arcs in order of source or target. This is useful for
+ * finding neighbors without too much overhead (maybe).
  * 
  * Mathematically speaking, this is a D-module without homotopy reduction
  */
@@ -49,13 +51,20 @@ class Arc_container : protected Node_container< Forest_options > {
  public:
   using Idem = typename Forest_options::Idem;
   using Alg_el = typename Forest_options::Alg_el;
+  using U_weights_type = typename Forest_options::Bordered_algebra::U_weights_type;
+  using Alg_el_pool =
+    typename Forest_options::Alg_el_storage::template Pool< Alg_el >;
+  using Alg_el_value = typename Alg_el_pool::Value;
   
   using Node_container = Node_container< Forest_options >;
   using typename Node_container::Root_handle;
   using typename Node_container::Root_handle_container;
   
+  /* The value of an arc is given by the algebra element storage policy of the
+   * forest options. Use value(arc) to get the corresponding algebra element.
+   */
   struct Arc {
-    Arc(int s, int t, Alg_el v) :
+    Arc(int s, int t, Alg_el_value v) :
       source(s),
       target(t),
       value(v)
@@ -63,7 +72,7 @@ class Arc_container : protected Node_container< Forest_options > {
     
     int source;
     int target;
-    Alg_el value;
+    Alg_el_value value;
     
     bool operator==(const Arc& other) const {
       return (source == other.source
@@ -90,24 +99,46 @@ class Arc_container : protected Node_container< Forest_options > {
   struct Source { };
   struct Target { };
   
-  using Arc_multi_index_container = boost::multi_index_container<
-    Arc,
-    boost::multi_index::indexed_by<
-      boost::multi_index::ordered_non_unique<
-        boost::multi_index::tag< Source >,
-        boost::multi_index::member< Arc, int, &Arc::source >
-      >,
-      boost::multi_index::ordered_non_unique<
-        boost::multi_index::tag< Target >,
-        boost::multi_index::member< Arc, int, &Arc::target >
-      >
-    >
-  >;
-  
-  using Arc_view = typename Arc_multi_index_container::template index< Source >::type;
+  using Arc_storage = typename Forest_options::Arc_storage;
+  using Arc_allocator = typename Forest_options::Arc_allocator;
+  using Arc_storage_container =
+    typename Arc_storage::template Container<
+      Arc,
+      Source,
+      Target,
+      typename Arc_allocator::template Allocator< Arc >
+    >;
+  
+  using Arc_view = typename Arc_storage_container::template index< Source >::type;
   using Arc_iterator = typename Arc_view::iterator;
   using Arc_reference = std::reference_wrapper< const Arc >;
   
+  /* Read-only view on a contiguous range of arc references, as returned by
+   * the others_* accessors after compute_arcs_at_nodes. The view is
+   * invalidated by any modification of the arcs.
+   */
+  class Arc_range {
+   public:
+    using value_type = Arc_reference;
+    using const_iterator = const Arc_reference*;
+    using iterator = const_iterator;
+    
+    Arc_range(const Arc_reference* begin, const Arc_reference* end) :
+      begin_(begin),
+      end_(end)
+    { }
+    
+    const_iterator begin() const { return begin_; }
+    const_iterator end() const { return end_; }
+    std::size_t size() const { return end_ - begin_; }
+    bool empty() const { return begin_ == end_; }
+    const Arc_reference& operator[](std::size_t i) const { return begin_[i]; }
+   
+   private:
+    const Arc_reference* begin_;
+    const Arc_reference* end_;
+  };
+  
  private:
   // Relative distances
   using Node_container::to_parent;
@@ -121,20 +152,31 @@ class Arc_container : protected Node_container< Forest_options > {
   
   /* OBSERVERS */
     
+  const Alg_el& value(const Arc& arc) const {
+    return alg_el_pool_.value(arc.value);
+  }
+  
   Idem source_idem(const Arc& arc) const {
-    return arc.value.source_idem();
+    return value(arc).source_idem();
   }
   
   Idem target_idem(const Arc& arc) const {
-    return arc.value.target_idem();
+    return value(arc).target_idem();
   }
   
-  std::vector< int > U_weights(const Arc& arc) const {
-    return arc.value.U_weights();
+  const U_weights_type& U_weights(const Arc& arc) const {
+    return value(arc).U_weights();
   }
   
   int U_weight(const Arc& arc, int position) const {
-    return arc.value.U_weight(position);
+    return value(arc).U_weight(position);
+  }
+  
+  /* Get the value to store in an arc for a given algebra element. Interning
+   * does not change the D-module, so this is const.
+   */
+  Alg_el_value intern(const Alg_el& alg_el) const {
+    return alg_el_pool_.intern(alg_el);
   }
   
   /* Views on arcs
@@ -159,35 +201,49 @@ class Arc_container : protected Node_container< Forest_options > {
     return arcs_.end();
   }
   
-  std::vector< Arc_reference > get_others_to_source(const Arc& arc) {
+  /* Find an arc equal to the given one, or return arcs_end(). */
+  Arc_iterator find_arc(const Arc& arc) const {
+    for (
+      auto arc_it = arcs_.lower_bound(arc.source);
+      arc_it != arcs_.end() and arc_it->source == arc.source;
+      ++arc_it
+    ) {
+      if (*arc_it == arc) {
+        return arc_it;
+      }
+    }
+    return arcs_.end();
+  }
+  
+  std::vector< Arc_reference > get_others_to_source(const Arc& arc) const {
     return get_arcs_at_node_< Target >(arc.source);
   }
   
-  std::vector< Arc_reference > get_others_from_target(const Arc& arc) {
+  std::vector< Arc_reference > get_others_from_target(const Arc& arc) const {
     return get_arcs_at_node_< Source >(arc.target);
   }
   
-  std::vector< Arc_reference > get_others_from_source(const Arc& arc) {
+  std::vector< Arc_reference > get_others_from_source(const Arc& arc) const {
     return get_arcs_at_node_< Source >(arc.source, arc);
   }
   
-  std::vector< Arc_reference > get_others_to_target(const Arc& arc) {
+  std::vector< Arc_reference > get_others_to_target(const Arc& arc) const {
     return get_arcs_at_node_< Target >(arc.target, arc);
   }
   
-  const std::vector< Arc_reference > others_to_source(const Arc& arc) const {
+  Arc_range others_to_source(const Arc& arc) const {
     return arcs_to_node_.at(arc.source);
   }
   
-  const std::vector< Arc_reference > others_from_target(const Arc& arc) const {
+  Arc_range others_from_target(const Arc& arc) const {
     return arcs_from_node_.at(arc.target);
   }
   
-  const std::vector< Arc_reference > others_from_source(const Arc& arc) const {
+  Arc_range others_from_source(const Arc& arc) const {
     return arcs_from_node_.at(arc.source); // need to avoid arc
   }
   
-  const std::vector< Arc_reference > others_to_target(const Arc& arc) const {
+  Arc_range others_to_target(const Arc& arc) const {
     return arcs_to_node_.at(arc.target); // need to avoid arc
   }
   
@@ -235,7 +291,10 @@ class Arc_container : protected Node_container< Forest_options > {
     return result;
   }
   
-  /* Arcs strictly below a node */
+  /* Arcs strictly below a node, that is, at its strict ancestors. Arcs are
+   * scanned backwards from the node down to its root, and ancestors are
+   * recognized by their descendant ranges, without walking up the tree.
+   */
   template< class Arc_view, class Arc_iterator >
   std::vector< Arc_reference >& arcs_below_node_(
     std::vector< Arc_reference >& arc_stream,
@@ -245,19 +304,16 @@ class Arc_container : protected Node_container< Forest_options > {
   ) const {
     auto get_endpoint = arcs_view.key_extractor();  // how costly is this?
     
-    auto parent_it = ++this->ascender(node);
+    const int root = this->root(node);
     int endpoint;
-    while (parent_it.valid() and arc_it != arcs_view.begin()) {
+    while (arc_it != arcs_view.begin()) {
       --arc_it;
       endpoint = get_endpoint(*arc_it);
       
-      if (endpoint < *parent_it) {
-        while (parent_it.valid() and endpoint < *parent_it) {
-          ++parent_it;
-        }
+      if (endpoint < root) {
+        break;
       }
-      
-      if (endpoint == *parent_it) {
+      if (this->is_ancestor(endpoint, node)) {
         arc_stream.emplace_back(*arc_it);
       }
     }
@@ -268,19 +324,102 @@ class Arc_container : protected Node_container< Forest_options > {
  public:
   /* MODIFIERS */
   
+  /* Remove all arcs and interned values. Vectors keep their capacity. */
   void clear_arcs() {
     arcs_.clear();
+    alg_el_pool_.clear();
+    invertible_arcs_.clear();
+    arcs_from_node_.clear();
+    arcs_to_node_.clear();
   }
   
   template< class Iterator >
   void insert_arcs(Iterator first, Iterator last) {
+    for (Iterator arc_it = first; arc_it != last; ++arc_it) {
+      note_invertible_(*arc_it);
+    }
     arcs_.insert(first, last);
   }
   
+  /* Same as insert_arcs followed by modulo_2, in bulk.
+   * 
+   * 1. Sort the arcs by source, with a counting sort.
+   * 2. Cancel identical arcs in pairs, sorting the arcs at each source by
+   * target and value hash. Sources are split into blocks, one per thread.
+   * 3. Find the arcs that overlap another arc, by sorting the remaining arcs
+   * by target - source and value hash, and keeping a stack of ancestors.
+   * 4. Insert the remaining arcs and only resolve overlaps for those found in
+   * step 3, in order of source.
+   * 
+   * Arcs that overlap no other arc are left untouched by modulo_2, and arcs
+   * raised while resolving an overlap overlap no other arc, so step 4 is
+   * modulo_2 on the remaining arcs. Since identical arcs cancel first, the
+   * result may differ from insert_arcs followed by modulo_2, but it
+   * represents the same D-module.
+   */
+  void insert_arcs_modulo_2(const std::vector< Arc >& arcs, int n_threads = 1) {
+    for (const Arc& arc : arcs) {
+      note_invertible_(arc);
+    }
+    const int n_arcs = arcs.size();
+    const int n_nodes = this->size();
+    
+    // 1. Counting sort by source, stable
+    std::vector< int > offsets(n_nodes + 1, 0);
+    for (const Arc& arc : arcs) {
+      ++offsets[arc.source + 1];
+    }
+    for (int node = 0; node < n_nodes; ++node) {
+      offsets[node + 1] += offsets[node];
+    }
+    std::vector< int > by_source(n_arcs);
+    std::vector< int > cursors(offsets.begin(), offsets.end() - 1);
+    for (int i = 0; i < n_arcs; ++i) {
+      by_source[cursors[arcs[i].source]++] = i;
+    }
+    
+    // 2. Cancel identical arcs
+    std::vector< char > keep(n_arcs, true);
+    const int n_blocks = std::max(1, std::min(n_threads, n_nodes));
+    parallel_for(n_blocks, n_threads, [&](int block) {
+      const int node_begin = static_cast< long >(block) * n_nodes / n_blocks;
+      const int node_end = static_cast< long >(block + 1) * n_nodes / n_blocks;
+      cancel_identical_arcs_(
+        arcs,
+        by_source.begin() + offsets[node_begin],
+        by_source.begin() + offsets[node_end],
+        keep
+      );
+    });
+    
+    // 3. Find overlapping arcs
+    std::vector< char > overlapping(n_arcs, false);
+    mark_overlapping_arcs_(arcs, keep, overlapping);
+    
+    // 4. Insert and resolve
+    std::vector< Arc > kept_arcs;
+    kept_arcs.reserve(n_arcs);
+    for (int i = 0; i < n_arcs; ++i) {
+      if (keep[i]) {
+        kept_arcs.push_back(arcs[i]);
+      }
+    }
+    arcs_.insert(kept_arcs.begin(), kept_arcs.end());
+    for (const int i : by_source) {
+      if (keep[i] and overlapping[i]) {
+        auto arc_it = find_arc(arcs[i]);
+        if (arc_it != arcs_.end()) {
+          resolve_overlaps_after_(arc_it);
+        }
+      }
+    }
+  }
+  
   /* Insert arc into container of locked arcs. The danger is if this creates
    * overlapping arcs.
    */
   void insert_arc(const Arc& arc) {
+    note_invertible_(arc);
     auto arc_it = arcs_.insert(arc).first;
     bool cancel_below = resolve_overlaps_before_(arc_it);
     if (!cancel_below) {
@@ -289,15 +428,38 @@ class Arc_container : protected Node_container< Forest_options > {
   }
   
   void basic_insert_arc(const Arc& arc) {
+    note_invertible_(arc);
     arcs_.insert(arc);
   }
   
+  /* Let the storage reorganize itself. This invalidates all iterators and
+   * references to arcs, so only call this between phases.
+   */
+  void consolidate_arcs() {
+    Arc_storage::consolidate(arcs_);
+  }
+  
+  /* Same, but the storage may decide that it is not worth it yet. */
+  void tidy_arcs() {
+    Arc_storage::tidy(arcs_);
+  }
+  
+  /* Every arc with an invertible value that was inserted since the last call,
+   * by any modifier. Some of these arcs may have been erased or raised since.
+   * This is how the forest keeps track of the arcs left to contract.
+   */
+  std::vector< Arc > take_invertible_arcs() {
+    std::vector< Arc > result;
+    result.swap(invertible_arcs_);
+    return result;
+  }
+  
   /* Delete all arcs whose source or target is above a given node.
    */
   template<
     class Tag,
     class Iterator =
-      typename Arc_multi_index_container::template index< Tag >::type::iterator
+      typename Arc_storage_container::template index< Tag >::type::iterator
   >
   Iterator erase_arcs_above_node(int node) {
     auto& arcs_view = arcs_.template get< Tag >();
@@ -308,52 +470,104 @@ class Arc_container : protected Node_container< Forest_options > {
   
   /* Calculate which arcs are adjacent to which nodes. This is used in the box
    * tensor product, where we no longer modify the forest.
+   * 
+   * The result is stored in compressed sparse row form: the arcs adjacent to
+   * a node are contiguous in one array, so that the others_* accessors return
+   * views instead of copies.
    */
   void compute_arcs_at_nodes() {
-    arcs_from_node_.clear();
-    arcs_to_node_.clear();
+    std::vector< int > endpoints;
+    endpoints.reserve(2 * arcs_.size());
     for (auto& arc : arcs_) {
-      arcs_from_node_[arc.source];
-      arcs_from_node_[arc.target];
-      arcs_to_node_[arc.source];
-      arcs_to_node_[arc.target];
+      endpoints.push_back(arc.source);
+      endpoints.push_back(arc.target);
     }
-    compute_arcs_at_node_< Source >(arcs_from_node_);
-    compute_arcs_at_node_< Target >(arcs_to_node_);
+    std::sort(endpoints.begin(), endpoints.end());
+    endpoints.erase(std::unique(endpoints.begin(), endpoints.end()), endpoints.end());
+    
+    arcs_from_node_.template build< Source >(*this, endpoints);
+    arcs_to_node_.template build< Target >(*this, endpoints);
   }
   
  private:
-  template< class Tag >
-  void compute_arcs_at_node_(std::map< int, std::vector< Arc_reference > >& arcs_at_node) const {
+  /* Arcs adjacent to nodes, in compressed sparse row form: the arcs at node i
+   * are arcs[offsets[i]] to arcs[offsets[i + 1] - 1].
+   */
+  struct Arcs_at_nodes_ {
+    std::vector< int > offsets;
+    std::vector< Arc_reference > arcs;
+    
+    Arc_range at(int node) const {
+      const Arc_reference* data = arcs.data();
+      return Arc_range(data + offsets[node], data + offsets[node + 1]);
+    }
+    
+    void clear() {
+      offsets.clear();
+      arcs.clear();
+    }
+    
+    /* Two passes over the same traversal: the first one counts the arcs at
+     * each node, the second one fills them in.
+     */
+    template< class Tag >
+    void build(const Arc_container& container, const std::vector< int >& endpoints) {
+      offsets.assign(container.size() + 1, 0);
+      container.template for_arcs_at_nodes_< Tag >(endpoints, [this](int node, const Arc&) {
+        ++offsets[node + 1];
+      });
+      for (int i = 0; i + 1 < offsets.size(); ++i) {
+        offsets[i + 1] += offsets[i];
+      }
+      
+      arcs.clear();
+      if (offsets.back() == 0) {
+        return;
+      }
+      std::vector< int > cursors(offsets.begin(), offsets.end() - 1);
+      arcs.assign(offsets.back(), Arc_reference(*container.arcs_.begin()));
+      container.template for_arcs_at_nodes_< Tag >(endpoints, [this, &cursors](int node, const Arc& arc) {
+        arcs[cursors[node]++] = arc;
+      });
+    }
+  };
+  
+  /* Call add(node, arc) for each node in endpoints and each arc whose
+   * endpoint, specified by Tag, is an ancestor of, a descendant of, or equal
+   * to the node. For a given node, the arcs come in the order ancestors, the
+   * node itself, descendants.
+   */
+  template< class Tag, class Function >
+  void for_arcs_at_nodes_(const std::vector< int >& endpoints, Function add) const {
     const auto& arcs_view = arcs_.template get< Tag >();
     auto get_endpoint = arcs_view.key_extractor();  // how costly is this?
     
     auto arc_it = arcs_view.begin();
     
-    for (auto lower_node_it = arcs_at_node.begin(); lower_node_it != arcs_at_node.end(); ++lower_node_it) {
-      const int lower_node = lower_node_it->first;
+    for (auto lower_node_it = endpoints.begin(); lower_node_it != endpoints.end(); ++lower_node_it) {
+      const int lower_node = *lower_node_it;
       
       for (; arc_it != arcs_view.end() and get_endpoint(*arc_it) < lower_node; ++arc_it) { }
       auto lower_arc_begin = arc_it;
       
       for (; arc_it != arcs_view.end() and get_endpoint(*arc_it) == lower_node; ++arc_it) {
-        arcs_at_node[lower_node].emplace_back(*arc_it);
+        add(lower_node, *arc_it);
       }
       auto lower_arc_end = arc_it;
       
       auto upper_arc_it = arc_it;
       for (
         auto upper_node_it = std::next(lower_node_it);
-        upper_node_it != arcs_at_node.end()
-          and upper_node_it->first < this->descendants_end(lower_node);
+        upper_node_it != endpoints.end()
+          and *upper_node_it < this->descendants_end(lower_node);
         ++upper_node_it
       ) {
-        int upper_node = upper_node_it->first;
+        int upper_node = *upper_node_it;
         for (; upper_arc_it != arcs_view.end() and get_endpoint(*upper_arc_it) == upper_node; ++upper_arc_it) {
-          lower_node_it->second.emplace_back(*upper_arc_it);
+          add(lower_node, *upper_arc_it);
         }
         for (auto lower_arc_it = lower_arc_begin; lower_arc_it != lower_arc_end; ++lower_arc_it) {
-          arcs_at_node[upper_node].emplace_back(*lower_arc_it);
+          add(upper_node, *lower_arc_it);
         }
       }
     }
@@ -411,7 +625,8 @@ class Arc_container : protected Node_container< Forest_options > {
       if (endpoint == *parent_it) {
         // raise the arc pointed to by arc_it
         for (const int new_endpoint : new_endpoints) {
-          arcs_view.emplace(
+          emplace_arc_(
+            arcs_view,
             new_endpoint + arc_it->source - endpoint,
             new_endpoint + arc_it->target - endpoint,
             arc_it->value
@@ -422,7 +637,132 @@ class Arc_container : protected Node_container< Forest_options > {
     }
   }
   
+  /* Merging arcs is the converse of raising them.
+   * 
+   * If every child c of a node p has an arc to c + d with the same value, and
+   * the subtree of p + d is the subtree of p shifted by d, weights included,
+   * then these arcs are replaced by one arc from p to p + d. Both represent the same
+   * coefficients. Raising arcs around a node and then erasing the node often
+   * leaves such arcs, for instance after a contraction.
+   * 
+   * This only merges arcs at the children of the given node, where the node
+   * is the source (Tag = Source) or target (Tag = Target) of the merged
+   * arcs. Return the number of arcs removed by merging.
+   */
+  template< class Tag >
+  int merge_arcs_at_children(int node) {
+    if (!this->has_children(node)) {
+      return 0;
+    }
+    const auto& arcs_view = arcs_.template get< Tag >();
+    auto get_endpoint = arcs_view.key_extractor();
+    
+    const int first_child = descendants_begin(node);
+    std::vector< Arc > first_arcs;
+    for (
+      auto arc_it = arcs_view.lower_bound(first_child);
+      arc_it != arcs_view.end() and get_endpoint(*arc_it) == first_child;
+      ++arc_it
+    ) {
+      first_arcs.push_back(*arc_it);
+    }
+    
+    int n_removed = 0;
+    for (const Arc& first_arc : first_arcs) {
+      const int offset = first_arc.target - first_arc.source;
+      const int source = first_arc.source - first_child + node;
+      if (
+        this->parent(first_arc.source) != source
+        or this->parent(first_arc.target) != source + offset
+        or !same_subtrees_(source, source + offset)
+        or find_arc(Arc(source, source + offset, first_arc.value)) != arcs_.end()
+      ) {
+        continue;
+      }
+      
+      std::vector< Arc_iterator > child_arc_its;
+      bool complete = true;
+      for (
+        int child = descendants_begin(source);
+        complete and child != descendants_end(source);
+        child += descendants_size(child)
+      ) {
+        auto arc_it = find_arc(Arc(child, child + offset, first_arc.value));
+        complete = (arc_it != arcs_.end());
+        child_arc_its.push_back(arc_it);
+      }
+      if (!complete) {
+        continue;
+      }
+      
+      for (const auto& arc_it : child_arc_its) {
+        arcs_.erase(arc_it);
+      }
+      emplace_arc_(arcs_, source, source + offset, first_arc.value);
+      n_removed += child_arc_its.size() - 1;
+    }
+    return n_removed;
+  }
+  
+  /* Merge arcs everywhere, from the leaves up, so that merged arcs can be
+   * merged again. Return the number of arcs removed by merging.
+   */
+  int merge_arcs() {
+    std::vector< int > nodes;
+    for (const auto& root_handle : this->root_idems_) {
+      for (
+        int node = root_handle.first;
+        node != this->descendants_end(root_handle.first);
+        node = this->next(node)
+      ) {
+        nodes.push_back(node);
+      }
+    }
+    int n_removed = 0;
+    for (auto node_it = nodes.rbegin(); node_it != nodes.rend(); ++node_it) {
+      n_removed += merge_arcs_at_children< Source >(*node_it);
+    }
+    return n_removed;
+  }
+ 
  private:
+  /* Whether the strict descendants of two nodes are at the same positions
+   * relative to the nodes, with the same weights. This is what an arc between
+   * the two nodes assumes when it is raised. Erased subtrees are skipped, so
+   * the nodes are visited through their children rather than in one range.
+   */
+  bool same_subtrees_(int node, int other_node) const {
+    const int offset = other_node - node;
+    std::vector< int > parents = {node};
+    while (!parents.empty()) {
+      const int parent = parents.back();
+      parents.pop_back();
+      int child = descendants_begin(parent);
+      int other_child = descendants_begin(parent + offset);
+      while (
+        child != descendants_end(parent)
+        and other_child != descendants_end(parent + offset)
+      ) {
+        if (
+          other_child != child + offset
+          or this->weights(other_child) != this->weights(child)
+        ) {
+          return false;
+        }
+        parents.push_back(child);
+        child += descendants_size(child);
+        other_child += descendants_size(other_child);
+      }
+      if (
+        child != descendants_end(parent)
+        or other_child != descendants_end(parent + offset)
+      ) {
+        return false;
+      }
+    }
+    return true;
+  }
+  
   /* Raise partially overlapping arcs (+ cancel exactly overlapping arcs)
    * 
    * Scan arcs above given arc. If one is found, mark its ancestors and move on
@@ -447,22 +787,25 @@ class Arc_container : protected Node_container< Forest_options > {
     
     // Scan descendants
     int start_node = lower_arc_it->source;
-    int n_nodes = descendants_size(start_node);
-    int end_node = start_node + n_nodes;
-    std::vector< bool > marked(n_nodes, false);  // parent of new endpoints
-    std::vector< bool > except(n_nodes, false);  // except these enpoints
+    int end_node = descendants_end(start_node);
+    if (marked_.size() < this->size()) {
+      marked_.resize(this->size(), false);
+      except_.resize(this->size(), false);
+    }
     
     while (upper_arc_it != arcs_.end() and upper_arc_it->source < end_node) {
       if (overlap_(*lower_arc_it, *upper_arc_it)) {
         // Mark ascendants
-        except[upper_arc_it->source - start_node] = true;
+        except_[upper_arc_it->source] = true;
+        except_nodes_.push_back(upper_arc_it->source);
         auto parent_it = ++this->ascender(upper_arc_it->source);
         while (
           parent_it.valid()
           and *parent_it >= start_node
-          and !marked[*parent_it - start_node]
+          and !marked_[*parent_it]
         ) {
-          marked[*parent_it - start_node] = true;
+          marked_[*parent_it] = true;
+          marked_nodes_.push_back(*parent_it);
           ++parent_it;
         }
         
@@ -477,15 +820,139 @@ class Arc_container : protected Node_container< Forest_options > {
       }
     }
     
+    if (marked_nodes_.empty()) {  // no overlaps
+      return std::next(lower_arc_it);
+    }
+    
     // Place new arcs
-    raise_arcs_after_(*lower_arc_it, marked, except, start_node);
+    raise_arcs_after_(*lower_arc_it, start_node);
+    for (const int node : marked_nodes_) {
+      marked_[node] = false;
+    }
+    for (const int node : except_nodes_) {
+      except_[node] = false;
+    }
+    marked_nodes_.clear();
+    except_nodes_.clear();
+    
+    lower_arc_it = arcs_.erase(lower_arc_it);  // arcs were raised
+    return lower_arc_it;
+  }
+  
+  /* Keys to sort arcs, by first, hash of the value, second and index in the
+   * original vector. Arcs with equal hashes may still have different values.
+   */
+  struct Arc_key_ {
+    int first;
+    int second;
+    std::size_t hash;
+    int index;
     
-    if (marked[0]) {  // arcs were raised
-      lower_arc_it = arcs_.erase(lower_arc_it);
-      return lower_arc_it;
+    bool operator<(const Arc_key_& other) const {
+      return std::tie(first, hash, second, index)
+        < std::tie(other.first, other.hash, other.second, other.index);
     }
-    else {
-      return std::next(lower_arc_it);
+    
+    bool same_group(const Arc_key_& other) const {
+      return first == other.first and second == other.second and hash == other.hash;
+    }
+  };
+  
+  /* Cancel identical arcs in pairs, among the arcs with given indices. These
+   * must all have the same source. The last arc of an odd group is kept, as
+   * in modulo_2.
+   */
+  void cancel_identical_arcs_(
+    const std::vector< Arc >& arcs,
+    std::vector< int >::const_iterator first,
+    std::vector< int >::const_iterator last,
+    std::vector< char >& keep
+  ) const {
+    std::vector< Arc_key_ > keys;
+    for (auto index_it = first; index_it != last; ) {
+      auto source_end = index_it;
+      for (; source_end != last and arcs[*source_end].source == arcs[*index_it].source; ++source_end) { }
+      if (source_end - index_it > 1) {
+        keys.clear();
+        for (; index_it != source_end; ++index_it) {
+          const Arc& arc = arcs[*index_it];
+          keys.push_back({arc.target, 0, alg_el_pool_.hash(arc.value), *index_it});
+        }
+        std::sort(keys.begin(), keys.end());
+        cancel_in_groups_(arcs, keys, keep);
+      }
+      index_it = source_end;
+    }
+  }
+  
+  /* Within each group of keys, cancel the arcs with equal values in pairs. */
+  void cancel_in_groups_(
+    const std::vector< Arc >& arcs,
+    std::vector< Arc_key_ >& keys,
+    std::vector< char >& keep
+  ) const {
+    for (auto group_it = keys.begin(); group_it != keys.end(); ) {
+      auto group_end = group_it;
+      for (; group_end != keys.end() and group_end->same_group(*group_it); ++group_end) { }
+      for (auto key_it = group_it; key_it != group_end; ++key_it) {
+        if (key_it->index < 0) {
+          continue;  // already cancelled or kept
+        }
+        // Keys are sorted by index within a group, so last is the last copy
+        int last = key_it->index;
+        bool odd = true;
+        for (auto other_it = std::next(key_it); other_it != group_end; ++other_it) {
+          if (other_it->index >= 0 and arcs[other_it->index].value == arcs[last].value) {
+            keep[last] = false;
+            last = other_it->index;
+            odd = !odd;
+            other_it->index = -1;
+          }
+        }
+        keep[last] = odd;
+      }
+      group_it = group_end;
+    }
+  }
+  
+  /* Mark the kept arcs that overlap another kept arc. Overlapping arcs have
+   * the same target - source and the same value, and the source of one is a
+   * descendant of the source of the other.
+   */
+  void mark_overlapping_arcs_(
+    const std::vector< Arc >& arcs,
+    const std::vector< char >& keep,
+    std::vector< char >& overlapping
+  ) const {
+    std::vector< Arc_key_ > keys;
+    for (int i = 0; i < arcs.size(); ++i) {
+      if (keep[i]) {
+        const Arc& arc = arcs[i];
+        keys.push_back({arc.target - arc.source, arc.source, alg_el_pool_.hash(arc.value), i});
+      }
+    }
+    std::sort(keys.begin(), keys.end());
+    
+    std::vector< int > ancestors;
+    for (int k = 0; k < keys.size(); ++k) {
+      if (k == 0 or keys[k].first != keys[k - 1].first or keys[k].hash != keys[k - 1].hash) {
+        ancestors.clear();
+      }
+      const Arc& arc = arcs[keys[k].index];
+      while (
+        !ancestors.empty()
+        and descendants_end(arcs[ancestors.back()].source) <= arc.source
+      ) {
+        ancestors.pop_back();
+      }
+      for (auto ancestor_it = ancestors.rbegin(); ancestor_it != ancestors.rend(); ++ancestor_it) {
+        if (arcs[*ancestor_it].value == arc.value) {
+          overlapping[*ancestor_it] = true;
+          overlapping[keys[k].index] = true;
+          break;
+        }
+      }
+      ancestors.push_back(keys[k].index);
     }
   }
   
@@ -528,31 +995,30 @@ class Arc_container : protected Node_container< Forest_options > {
             and lower_arc.value == upper_arc.value);
   }
   
-  /* Raise original arc to avoid all marked nodes. The vector marked is
-   * indexed relatively to a start node.
+  /* Raise original arc to avoid all marked nodes, given by the scratch
+   * storage of resolve_overlaps_after_.
    * 
    * Raising arcs means placing an arc at each unmarked node whose parent is
-   * marked.
-   */
-  void raise_arcs_after_(
-    const Arc& old_arc,
-    const std::vector< bool >& marked,
-    const std::vector< bool >& except,
-    const int start_node
-  ) {
-    for (int rel_node = 1; rel_node != marked.size(); ) {  // relative node index
-      if (
-        !marked[rel_node]
-        and !except[rel_node]
-        and marked[rel_node - to_parent(start_node + rel_node)]
+   * marked. Only the children of marked nodes are visited, and new arcs are
+   * placed in preorder.
+   */
+  void raise_arcs_after_(const Arc& old_arc, const int start_node) {
+    new_endpoints_.clear();
+    for (const int node : marked_nodes_) {
+      for (
+        int child = descendants_begin(node);
+        child != descendants_end(node);
+        child += descendants_size(child)
       ) {
-        arcs_.emplace(start_node + rel_node, old_arc.target + rel_node, old_arc.value);
-        rel_node += descendants_size(start_node + rel_node);
-      }
-      else {
-        rel_node += this->to_next(start_node + rel_node);
+        if (!marked_[child] and !except_[child]) {
+          new_endpoints_.push_back(child);
+        }
       }
     }
+    std::sort(new_endpoints_.begin(), new_endpoints_.end());
+    for (const int node : new_endpoints_) {
+      emplace_arc_(arcs_, node, old_arc.target + node - start_node, old_arc.value);
+    }
   }
   
   /* ancestors holds source node and all of its ancestors up to the lower
@@ -568,12 +1034,26 @@ class Arc_container : protected Node_container< Forest_options > {
            child != descendants_end(parent);
            child += descendants_size(child)) {
         if (child != ancestors[i - 1]) {
-          arcs_.emplace(child, old_arc.target + child - old_arc.source, old_arc.value);
+          emplace_arc_(arcs_, child, old_arc.target + child - old_arc.source, old_arc.value);
         }
       }
     }
   }
   
+  /* Insert a raised arc in one of the views. */
+  template< class View >
+  void emplace_arc_(View& arcs_view, int source, int target, Alg_el_value value) {
+    const Arc arc(source, target, value);
+    note_invertible_(arc);
+    arcs_view.insert(arc);
+  }
+  
+  void note_invertible_(const Arc& arc) {
+    if (value(arc).is_invertible()) {
+      invertible_arcs_.push_back(arc);
+    }
+  }
+  
   std::vector< int > children_(int node) const {
     std::vector< int > children;
     for (
@@ -626,11 +1106,119 @@ class Arc_container : protected Node_container< Forest_options > {
   Arc concatenate(const Arc& back_arc, const Arc& front_arc) const {
     int difference = front_arc.source - back_arc.target;
     if (difference >= 0) {
-      return Arc(back_arc.source + difference, front_arc.target, back_arc.value * front_arc.value);
+      return Arc(back_arc.source + difference, front_arc.target, intern(value(back_arc) * value(front_arc)));
     }
     else {
-      return Arc(back_arc.source, front_arc.target - difference, back_arc.value * front_arc.value);
+      return Arc(back_arc.source, front_arc.target - difference, intern(value(back_arc) * value(front_arc)));
+    }
+  }
+  
+  /* Front arcs of concatenate_groups, sorted by source, so that a group that
+   * is concatenated many times is only sorted once. For each arc, enclosing
+   * is the index of the last arc whose source is a strict ancestor of its
+   * source, or -1.
+   */
+  struct Front_group {
+    std::vector< Arc > arcs;
+    std::vector< int > sources;
+    std::vector< Idem > target_idems;
+    std::vector< int > enclosing;
+  };
+  
+  Front_group front_group(std::vector< Arc > front_arcs) const {
+    Front_group group;
+    std::stable_sort(front_arcs.begin(), front_arcs.end(), [](const Arc& arc, const Arc& other) {
+      return arc.source < other.source;
+    });
+    group.arcs.swap(front_arcs);
+    std::vector< int > ancestors;  // last index of each group of equal sources
+    for (int k = 0; k < group.arcs.size(); ++k) {
+      const Arc& arc = group.arcs[k];
+      group.sources.push_back(arc.source);
+      group.target_idems.push_back(target_idem(arc));
+      if (k > 0 and arc.source == group.sources[k - 1]) {
+        group.enclosing.push_back(group.enclosing[k - 1]);
+        ancestors.back() = k;
+        continue;
+      }
+      while (
+        !ancestors.empty()
+        and this->descendants_end(group.sources[ancestors.back()]) <= arc.source
+      ) {
+        ancestors.pop_back();
+      }
+      group.enclosing.push_back(ancestors.empty() ? -1 : ancestors.back());
+      ancestors.push_back(k);
     }
+    return group;
+  }
+  
+  /* Concatenate all compatible pairs of back and front arcs whose outer
+   * idempotents are not too far apart, modulo 2.
+   * 
+   * Subtrees are nested or disjoint, so a pair is compatible if and only if
+   * the front source is in the range [target, descendants_end(target)) of the
+   * back target, or is a strict ancestor of the back target. For each back
+   * arc, the first front arcs are found by binary search, and the second by
+   * following enclosing front arcs from the last front source before the
+   * back target. Idempotents are only compared for compatible pairs.
+   * Identical products then cancel in pairs, as in insert_arcs_modulo_2.
+   */
+  std::vector< Arc > concatenate_groups(
+    const std::vector< Arc >& back_arcs,
+    const std::vector< Arc >& front_arcs
+  ) const {
+    return concatenate_groups(back_arcs, front_group(front_arcs));
+  }
+  
+  std::vector< Arc > concatenate_groups(
+    const std::vector< Arc >& back_arcs,
+    const Front_group& front_group
+  ) const {
+    const std::vector< int >& sources = front_group.sources;
+    std::vector< Arc > products;
+    for (const Arc& back_arc : back_arcs) {
+      const Idem back_idem = source_idem(back_arc);
+      auto add_product = [&](int k) {
+        if (!back_idem.too_far_from(front_group.target_idems[k])) {
+          products.push_back(concatenate(back_arc, front_group.arcs[k]));
+        }
+      };
+      const int target = back_arc.target;
+      // Front source at or below back target
+      const int first = std::lower_bound(sources.begin(), sources.end(), target) - sources.begin();
+      const int last = std::lower_bound(sources.begin() + first, sources.end(), this->descendants_end(target)) - sources.begin();
+      for (int k = first; k < last; ++k) {
+        add_product(k);
+      }
+      // Front source strictly above back target
+      for (int k = first - 1; k >= 0; k = front_group.enclosing[k]) {
+        if (this->descendants_end(sources[k]) > target) {
+          for (int l = k; l >= 0 and sources[l] == sources[k]; --l) {
+            add_product(l);
+          }
+        }
+      }
+    }
+    
+    /* modulo 2 */
+    const int n_products = products.size();
+    std::vector< int > by_source(n_products);
+    for (int p = 0; p < n_products; ++p) {
+      by_source[p] = p;
+    }
+    std::stable_sort(by_source.begin(), by_source.end(), [&](int p, int q) {
+      return products[p].source < products[q].source;
+    });
+    std::vector< char > keep(n_products, true);
+    cancel_identical_arcs_(products, by_source.begin(), by_source.end(), keep);
+    std::vector< Arc > result;
+    for (int p = 0; p < n_products; ++p) {
+      if (keep[p]) {
+        result.push_back(products[p]);
+      }
+    }
+    return result;
   }
   
   /* Update arc endpoints. No modification should rearrange arcs, so iterating
@@ -640,6 +1228,7 @@ class Arc_container : protected Node_container< Forest_options > {
    * we are modifying the key...
    */
   void update_arc_endpoints(const std::vector< int >& offsets) {
+    consolidate_arcs();
     for (auto arc_it = arcs_.begin(); arc_it != arcs_.end(); ++arc_it) {
       arcs_.modify(arc_it, [&](Arc& arc) { arc.source -= offsets[arc.source]; });
     }
@@ -654,7 +1243,13 @@ class Arc_container : protected Node_container< Forest_options > {
   
   friend std::ostream& operator<<(std::ostream& os, const Arc_container& ac) {
     for (auto& arc : ac.arcs_) {
-      os << arc << " ";
+      os << "("
+         << arc.source
+         << "|"
+         << ac.value(arc)
+         << "|"
+         << arc.target
+         << ") ";
     }
     return os;
   }
@@ -667,7 +1262,7 @@ class Arc_container : protected Node_container< Forest_options > {
       write_file << "\\path ("
                  << arc.source
                  << ") edge[differential arc, bend left=10] node[in place]{$"
-                 << extra_options << arc.value
+                 << extra_options << value(arc)
                  << "$} ("
                  << arc.target
                  << ");" << std::endl;
@@ -676,10 +1271,22 @@ class Arc_container : protected Node_container< Forest_options > {
 #endif  // BUNDLED_HFK_DRAW_
   
  protected:
-  Arc_multi_index_container arcs_;
+  Arc_storage_container arcs_;
+  mutable Alg_el_pool alg_el_pool_;
+  std::vector< Arc > invertible_arcs_;
+  
+  Arcs_at_nodes_ arcs_from_node_;
+  Arcs_at_nodes_ arcs_to_node_;
   
-  std::map< int, std::vector< Arc_reference > > arcs_from_node_;
-  std::map< int, std::vector< Arc_reference > > arcs_to_node_;
+  /* Scratch storage for resolve_overlaps_after_, indexed by node. Flags are
+   * cleared after each call, by going through the lists of touched nodes, so
+   * the cost of a call does not depend on the size of the subtree.
+   */
+  std::vector< char > marked_;  // parents of new endpoints
+  std::vector< char > except_;  // except these endpoints
+  std::vector< int > marked_nodes_;
+  std::vector< int > except_nodes_;
+  std::vector< int > new_endpoints_;
 };
 
 #endif  // ARC_CONTAINER_H_
\ No newline at end of file
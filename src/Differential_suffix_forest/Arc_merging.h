@@ -20,37 +20,25 @@
  *                                                                           *
 \* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
 
-#ifndef TWO_BIT_SET_H_
-#define TWO_BIT_SET_H_
+#ifndef ARC_MERGING_H_
+#define ARC_MERGING_H_
 
-#include <bitset>
-
-/* Two bit set.
- *
- * Auxiliary class for positive crossings. Current convention is big-endian.
+/* Arc merging policies.
+ * 
+ * An arc merging policy tells Differential_suffix_forest whether to merge
+ * raised arcs back into one arc at their parents (see
+ * Arc_container::merge_arcs_at_children): after locking coefficients, around
+ * the nodes erased by each contraction, and once more after reduction. Merged
+ * arcs represent the same coefficients, so the homology does not change, but
+ * every merge attempt looks up one arc per child, and a full pass is made on
+ * every layer.
  */
-template< std::size_t size >
-class Two_bit_set {
- public:
-  using Storage = std::bitset< 2 * size >;
-  
-  Two_bit_set() { }
-  
-  int operator[](int i) const {
-    return table_[2 * i] + 2 * table_[2 * i + 1];
-  }
-  
-  void set_value(int i, int value) {
-    table_[2 * i] = value & 1;
-    table_[2 * i + 1] = (value >> 1) & 1;
-  }
-  
-  std::string to_string() const {
-    return table_.to_string();
-  }
-  
- private:
-  Storage table_;
+struct No_arc_merging {
+  static constexpr bool merge_raised_arcs = false;
+};
+
+struct Raised_arc_merging {
+  static constexpr bool merge_raised_arcs = true;
 };
 
-#endif  // TWO_BIT_SET_H_
\ No newline at end of file
+#endif  // ARC_MERGING_H_
@@ -0,0 +1,123 @@
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *\
+ *                                                                           *
+ *  Bundled HFK - a knot Floer homology calculator                           *
+ *                                                                           *
+ *  Copyright (C) 2021-2022  Isaac Ren                                       *
+ *  For further details, contact Isaac Ren (gopi3.1415@gmail.com).           *
+ *                                                                           *
+ *  This program is free software: you can redistribute it and/or modify     *
+ *  it under the terms of the GNU General Public License as published by     *
+ *  the Free Software Foundation, either version 3 of the License, or        *
+ *  (at your option) any later version.                                      *
+ *                                                                           *
+ *  This program is distributed in the hope that it will be useful,          *
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of           *
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the            *
+ *  GNU General Public License for more details.                             *
+ *                                                                           *
+ *  You should have received a copy of the GNU General Public License        *
+ *  along with this program.  If not, see <https://www.gnu.org/licenses/>.   *
+ *                                                                           *
+\* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+
+#ifndef ARC_STORAGE_H_
+#define ARC_STORAGE_H_
+
+#include <boost/multi_index_container.hpp>
+#include <boost/multi_index/ordered_index.hpp>
+#include <boost/multi_index/member.hpp>
+
+#include <memory>  // allocator
+
+#include "Flat_arc_container.h"
+#include "Utility/Pool_allocator.h"
+
+/* Arc storage policies.
+ * 
+ * An arc storage policy tells Arc_container how to store arcs. It provides
+ * a container template, indexed by source and target nodes, and a
+ * consolidate function, called by the forest whenever a phase of the
+ * algorithm is over and no iterators or references to arcs are held.
+ * 
+ * The tidy function is called within a phase, whenever no iterators or
+ * references are held. It may consolidate, if this is worth the cost.
+ * 
+ * The container template also takes an allocator of arcs, given by the arc
+ * allocator policy of the forest options (see below).
+ */
+
+/* Boost multi-index container: two balanced trees. Insertions and deletions
+ * are cheap at all times, but the arcs are scattered in memory.
+ */
+struct Multi_index_arc_storage {
+  template< class Arc, class Source, class Target, class Allocator >
+  using Container = boost::multi_index_container<
+    Arc,
+    boost::multi_index::indexed_by<
+      boost::multi_index::ordered_non_unique<
+        boost::multi_index::tag< Source >,
+        boost::multi_index::member< Arc, int, &Arc::source >
+      >,
+      boost::multi_index::ordered_non_unique<
+        boost::multi_index::tag< Target >,
+        boost::multi_index::member< Arc, int, &Arc::target >
+      >
+    >,
+    Allocator
+  >;
+  
+  template< class Container >
+  static void consolidate(Container&) { }
+  
+  template< class Container >
+  static void tidy(Container&) { }
+};
+
+/* Flat container: arcs sorted by source in a vector, plus a permutation
+ * sorted by target. Iterating is cache-friendly, but modifications go to
+ * small buffers until the next consolidation. Vectors do not benefit from a
+ * node pool, so the allocator is ignored.
+ */
+struct Flat_arc_storage {
+  template< class Arc, class Source, class Target, class Allocator >
+  using Container = Flat_arc_container< Arc, Source, Target >;
+  
+  template< class Container >
+  static void consolidate(Container& arcs) {
+    arcs.consolidate();
+  }
+  
+  /* Consolidating is linear in the number of arcs, so wait until the buffers
+   * hold a fixed fraction of the arcs.
+   */
+  template< class Container >
+  static void tidy(Container& arcs) {
+    if (8 * arcs.n_pending() > arcs.size()) {
+      arcs.consolidate();
+    }
+  }
+};
+
+/* Arc allocator policies.
+ * 
+ * An arc allocator policy gives the allocator template used by the arc
+ * storage.
+ */
+
+/* General-purpose allocation. */
+struct Standard_arc_allocator {
+  template< class T >
+  using Allocator = std::allocator< T >;
+};
+
+/* Each arc container allocates its tree nodes from its own node pool (see
+ * Pool_allocator.h). Erasing and raising arcs reuses freed nodes instead of
+ * calling malloc, and clearing the forest between layers keeps the nodes for
+ * the next layer. The memory goes back to the system with the forest.
+ */
+struct Pool_arc_allocator {
+  template< class T >
+  using Allocator = Pool_allocator< T >;
+};
+
+#endif  // ARC_STORAGE_H_
@@ -0,0 +1,79 @@
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *\
+ *                                                                           *
+ *  Bundled HFK - a knot Floer homology calculator                           *
+ *                                                                           *
+ *  Copyright (C) 2021-2022  Isaac Ren                                       *
+ *  For further details, contact Isaac Ren (gopi3.1415@gmail.com).           *
+ *                                                                           *
+ *  This program is free software: you can redistribute it and/or modify     *
+ *  it under the terms of the GNU General Public License as published by     *
+ *  the Free Software Foundation, either version 3 of the License, or        *
+ *  (at your option) any later version.                                      *
+ *                                                                           *
+ *  This program is distributed in the hope that it will be useful,          *
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of           *
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the            *
+ *  GNU General Public License for more details.                             *
+ *                                                                           *
+ *  You should have received a copy of the GNU General Public License        *
+ *  along with this program.  If not, see <https://www.gnu.org/licenses/>.   *
+ *                                                                           *
+\* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+
+#ifndef CONTRACTION_ORDER_H_
+#define CONTRACTION_ORDER_H_
+
+/* Contraction order policies.
+ * 
+ * A contraction order policy tells Differential_suffix_forest::reduce in
+ * which order to contract invertible arcs. Contracting an arc creates one
+ * zig-zag arc per compatible pair of back and front arcs (see contract_), and
+ * these new arcs may be contracted later, so the order changes the amount of
+ * fill-in.
+ * 
+ * The order may also change the result. Zig-zag arcs whose idempotents are
+ * too far apart are not created, and products are computed in a quotient of
+ * the algebra, so the arcs are not an exact differential and contracting two
+ * invertible arcs from the same generator in different orders may give
+ * different homologies. Contracting in order of source, which contracts the
+ * arcs of an ancestor before those of its descendants, gives the reference
+ * result. A policy is only kept here if it gives the same Poincaré
+ * polynomials as Source_contraction_order on every file of data/csv; see
+ * data/csv/contraction_order_disagreement.csv for a diagram on which
+ * contracting arcs between the deepest nodes first gives the wrong result.
+ * 
+ * A policy provides a key type and a key function: arcs with smaller keys are
+ * contracted first, and ties are broken by source and target. If reevaluate
+ * is true, the key of an arc may grow as the forest changes, so it is
+ * computed again before contracting: if it grew, the arc is put back in the
+ * worklist.
+ */
+
+/* Contract arcs in order of source. Arcs that appear below the current arc
+ * during reduction are contracted next.
+ */
+struct Source_contraction_order {
+  using Key = int;
+  static constexpr bool reevaluate = false;
+  
+  template< class Forest, class Arc >
+  static Key key(const Forest&, const Arc&) {
+    return 0;
+  }
+};
+
+/* Contract arcs with the fewest zig-zag arcs first, as in the Markowitz
+ * pivoting rule for sparse matrices. The number of zig-zag arcs is bounded
+ * by the product of the numbers of back arcs and front arcs.
+ */
+struct Fewest_neighbors_contraction_order {
+  using Key = long;
+  static constexpr bool reevaluate = true;
+  
+  template< class Forest, class Arc >
+  static Key key(const Forest& forest, const Arc& arc) {
+    return forest.contraction_cost(arc);
+  }
+};
+
+#endif  // CONTRACTION_ORDER_H_
@@ -23,12 +23,15 @@
 #ifndef DIFFERENTIAL_SUFFIX_FOREST_H_
 #define DIFFERENTIAL_SUFFIX_FOREST_H_
 
+#include <algorithm>  // min
 #include <fstream>
 #include <functional>  // reference_wrapper
 #include <iostream>
+#include <iterator>  // back_inserter
 #include <map>
+#include <queue>  // priority_queue
 #include <string>
-#include <utility>  // pair
+#include <utility>  // move, pair
 #include <vector>
 
 #include <boost/multi_index_container.hpp>
@@ -68,6 +71,11 @@ class Differential_suffix_forest : private Arc_container< Forest_options > {
   using Weights = typename Forest_options::Weights;
   
   using Arc_container = Arc_container< Forest_options >;
+  using Contraction_order = typename Forest_options::Contraction_order;
+  using Key = typename Contraction_order::Key;
+  using Reduction_parallelism = typename Forest_options::Reduction_parallelism;
+  using Arc_merging = typename Forest_options::Arc_merging;
+  using Node_storage = typename Forest_options::Node_storage;
   using Node_container = typename Arc_container::Node_container;
   
   /* Member types inherited from Node_container and Arc_container */
@@ -78,6 +86,7 @@ class Differential_suffix_forest : private Arc_container< Forest_options > {
   using Arc_view = typename Arc_container::Arc_view;
   using Arc_iterator = typename Arc_container::Arc_iterator;
   using Arc_reference = typename Arc_container::Arc_reference;
+  using Arc_range = typename Arc_container::Arc_range;
   using Source = typename Arc_container::Source;
   using Target = typename Arc_container::Target;
   
@@ -88,6 +97,7 @@ class Differential_suffix_forest : private Arc_container< Forest_options > {
   using Coef_bundle_container = Arc_view;
   using Coef_bundle_iterator = Arc_iterator;
   using Coef_bundle_reference = Arc_reference;
+  using Coef_bundle_range = Arc_range;
   
   /* Member functions inherited from Node_container and Arc_container */
   using Node_container::idem;
@@ -105,6 +115,8 @@ class Differential_suffix_forest : private Arc_container< Forest_options > {
   
   using Arc_container::compatible;
   using Arc_container::concatenate;
+  using Arc_container::concatenate_groups;
+  using Arc_container::front_group;
   
  private:
   // Relative distances
@@ -126,9 +138,55 @@ class Differential_suffix_forest : private Arc_container< Forest_options > {
     return this->arcs_;
   }
   
-  void set_as_trivial() {
+  /* At most the number of zig-zag arcs created by contracting an arc. Arcs
+   * are raised before contracting, so this is only an estimate.
+   */
+  long contraction_cost(const Arc& arc) const {
+    return (static_cast< long >(this->get_others_to_target(arc).size())
+            * this->get_others_from_source(arc).size());
+  }
+  
+  /* Fill-in of a homotopy reduction, returned by reduce(). Contractions create
+   * zig-zag arcs, some of which are contracted later. With a contraction
+   * order that reevaluates keys, arcs may be put back in the worklist. With
+   * arc merging, raised arcs are merged back into one arc, and the arcs left
+   * after reduction show how many arcs this saves. With hash-consed node
+   * storage, repeated nodes are shared with an identical subtree instead of
+   * being stored again.
+   */
+  struct Reduction_statistics {
+    long n_contractions;
+    long n_zigzag_arcs;
+    long n_reevaluations;
+    long n_merged_arcs;
+    long n_reduced_arcs;
+    long n_repeated_nodes;
+    
+    Reduction_statistics& operator+=(const Reduction_statistics& other) {
+      n_contractions += other.n_contractions;
+      n_zigzag_arcs += other.n_zigzag_arcs;
+      n_reevaluations += other.n_reevaluations;
+      n_merged_arcs += other.n_merged_arcs;
+      n_reduced_arcs += other.n_reduced_arcs;
+      n_repeated_nodes += other.n_repeated_nodes;
+      return *this;
+    }
+  };
+  
+  /* Remove all generators and coefficients. The forest keeps its allocated
+   * storage, so that it can be reused for a later layer (see
+   * box_tensor_product in DA_bimodule.h).
+   */
+  void clear() {
     this->clear_nodes();
     this->clear_arcs();
+    declared_subtrees_.clear();
+    declared_arcs_.clear();
+    first_layer_nodes_.clear();
+  }
+  
+  void set_as_trivial() {
+    clear();
     add_gen_bundle(Idem("0"));
     lock_generators();
     lock_coefficients();
@@ -188,6 +246,7 @@ class Differential_suffix_forest : private Arc_container< Forest_options > {
       }
     }
     declared_subtrees_.clear();
+    this->build_ancestor_index();
   }
   
   /* Lock subtrees, but only the roots */
@@ -197,6 +256,7 @@ class Differential_suffix_forest : private Arc_container< Forest_options > {
       const Idem& new_idem = map_value.first;
       this->push_back_root(new_idem);
     }
+    this->build_ancestor_index();
   }
   
   /* Arc creation
@@ -239,7 +299,7 @@ class Differential_suffix_forest : private Arc_container< Forest_options > {
     int target = first_layer_nodes_.at({new_value.target_idem(), front_marking});
     source += old_forest.to_root(old_arc.source);
     target += old_forest.to_root(old_arc.target);
-    declared_arcs_.emplace_back(source, target, new_value);
+    declared_arcs_.emplace_back(source, target, this->intern(new_value));
   }
   
   /* Overloaded version without old forest, as in the following drawing:
@@ -263,85 +323,170 @@ class Differential_suffix_forest : private Arc_container< Forest_options > {
     if (new_value.is_null()) { return; }
     int source = first_layer_nodes_.at({new_value.source_idem(), back_marking});
     int target = first_layer_nodes_.at({new_value.target_idem(), front_marking});
-    declared_arcs_.emplace_back(source, target, new_value);
+    declared_arcs_.emplace_back(source, target, this->intern(new_value));
   }
   
   /* Lock coefficients and ensure that each coefficient is only accounted for
-   * once.
+   * once. See Arc_container::insert_arcs_modulo_2.
    */
   void lock_coefficients() {
-    this->insert_arcs(declared_arcs_.begin(), declared_arcs_.end());
-    this->modulo_2();
+    this->insert_arcs_modulo_2(declared_arcs_, Reduction_parallelism::n_threads());
+    if (Arc_merging::merge_raised_arcs) {
+      this->merge_arcs();
+    }
   }
   
  public:
   /* Homotopy reduction of the forest to an irreducible one.
+   * 
+   * Invertible arcs are contracted from a worklist, in the contraction order
+   * of the forest options (see Contraction_order.h). The arc container
+   * reports every invertible arc that it inserts: declared arcs at
+   * lock_coefficients, raised arcs and zig-zag arcs. Entries whose arc has
+   * been erased or raised since are skipped. A final scan checks that no
+   * invertible arc was missed.
+   * 
+   * With a parallel reduction policy, the zig-zag arcs of each contraction
+   * are computed on several threads (see Reduction_parallelism.h). This does
+   * not change the result.
+   * 
+   * Return the fill-in of the reduction (see Reduction_statistics).
    * 
    * /!\ Arc insertion is not 100% correct. The bad case is: zig-zag makes an
    * invertible arc, and checking below for overlaps is not enough, and then
    * one of the overlapping arcs is selected for inversion. Result: infinite
    * loop.
    */
-  void reduce() {
-    bool reduction = true;
-    int counter = 0;
-    while (reduction) {
-      reduction = false;
-      for (auto arc_it = this->arcs_begin(); arc_it != this->arcs_end(); ) {
-        if (arc_it->value.is_invertible()) {
-          reduction = true;
-          std::clog << "[f] invertible arc " << *arc_it << "\n";
-          arc_it = contract_(arc_it);
+  Reduction_statistics reduce() {
+    std::priority_queue<
+      Candidate_,
+      std::vector< Candidate_ >,
+      Later_candidate_
+    > worklist;
+    Reduction_statistics statistics{};
+    
+    while (true) {
+      for (const Arc& arc : this->take_invertible_arcs()) {
+        worklist.push({Contraction_order::key(*this, arc), arc});
+      }
+      
+      if (worklist.empty()) {
+        // Final scan
+        this->consolidate_arcs();
+        for (auto arc_it = this->arcs_begin(); arc_it != this->arcs_end(); ++arc_it) {
+          if (this->value(*arc_it).is_invertible()) {
+            worklist.push({Contraction_order::key(*this, *arc_it), *arc_it});
+          }
         }
-        else {
-          ++arc_it;
+        if (worklist.empty()) {
+          break;
+        }
+      }
+      
+      const Candidate_ candidate = worklist.top();
+      worklist.pop();
+      const auto arc_it = this->find_arc(candidate.arc);
+      if (arc_it == this->arcs_end()) {
+        continue;
+      }
+      if (Contraction_order::reevaluate) {
+        const Key new_key = Contraction_order::key(*this, candidate.arc);
+        if (candidate.key < new_key) {
+          worklist.push({new_key, candidate.arc});
+          ++statistics.n_reevaluations;
+          continue;
         }
       }
-      std::clog << "[f] pass #" << ++counter << std::endl;
+      statistics.n_zigzag_arcs += contract_(arc_it, statistics);
+      ++statistics.n_contractions;
+      this->tidy_arcs();
     }
     
+    this->consolidate_arcs();
     this->modulo_2();
+    if (Arc_merging::merge_raised_arcs) {
+      statistics.n_merged_arcs += this->merge_arcs();
+    }
+    statistics.n_reduced_arcs += this->arcs_.size();
     
     const auto offsets = this->node_offsets();
     this->prune_nodes(offsets);
     this->update_arc_endpoints(offsets);
+    if (Node_storage::share_identical_subtrees) {
+      statistics.n_repeated_nodes += this->share_identical_subtrees();
+    }
+    this->build_ancestor_index();
 #ifdef BUNDLED_HFK_VERBOSE_
-    std::clog << "\n[f] number of nodes: " << this->nodes_.size()
+    std::clog << "\n[f] number of contractions: " << statistics.n_contractions
+      << "\n[f] number of zig-zag arcs: " << statistics.n_zigzag_arcs
+      << "\n[f] number of nodes: " << this->nodes_.size()
       << "\n[f] number of generators: " << this->n_leaves()
       << "\n[f] number of arcs: " << this->arcs_.size() << std::endl;
 #endif  // BUNDLED_HFK_VERBOSE_
     
     this->compute_arcs_at_nodes();
+    return statistics;
   }
   
  private:
-  /* Contract an invertible arc. Return the next arc.
+  /* Entries of the reduction worklist, with the key given by the contraction
+   * order when the entry was pushed.
+   */
+  struct Candidate_ {
+    Key key;
+    Arc arc;
+  };
+  
+  /* std::priority_queue puts the greatest element first, so the candidate
+   * with the smallest key, source and target is the "greatest".
+   */
+  struct Later_candidate_ {
+    bool operator()(const Candidate_& left, const Candidate_& right) const {
+      if (left.key < right.key or right.key < left.key) {
+        return right.key < left.key;
+      }
+      return (left.arc.source > right.arc.source
+              or (left.arc.source == right.arc.source
+                  and left.arc.target > right.arc.target));
+    }
+  };
+  
+  /* Zig-zag arcs, before their values are interned. Computing these does not
+   * modify the forest, so several threads may do it at once.
+   */
+  struct Zigzag_ {
+    int source;
+    int target;
+    Alg_el value;
+  };
+  
+  /* Pair of back and front arcs kept by the first pass of zigzags_, along
+   * with the endpoints of the zig-zag arc.
+   */
+  struct Zigzag_pair_ {
+    int back;
+    int front;
+    int source;
+    int target;
+  };
+  
+  /* Contract an invertible arc. Return the number of zig-zag arcs inserted.
    * 
    * Note for mathematicians: it is not possible to have a back arc equal to
    * front arc, for grading reasons.
    */
-  Arc_iterator contract_(const Arc_iterator& reverse_arc_it) {
-    std::vector< Arc > zigzag_arcs;
-    
+  int contract_(const Arc_iterator& reverse_arc_it, Reduction_statistics& statistics) {
     const Arc& reverse_arc = *reverse_arc_it;
     raise_to_critical_(reverse_arc);
     
     const auto back_arcs = this->get_others_to_target(reverse_arc);
     const auto front_arcs = this->get_others_from_source(reverse_arc);
+    const std::vector< Zigzag_ > zigzags =
+      zigzags_(back_arcs, reverse_arc, front_arcs);
     
-    for (const Arc& back_arc : back_arcs) {
-      for (const Arc& front_arc : front_arcs) {
-//         std::cout << "[f] Making zig-zag arc from "
-//           << back_arc << " "
-//           << reverse_arc << " "
-//           << front_arc << std::endl;
-        zigzag_arcs = add_zigzag_(zigzag_arcs, back_arc, reverse_arc, front_arc);
-      }
-    }
-    
-    for (const Arc& zigzag_arc : zigzag_arcs) {
-//      std::cout << "[f] Inserting zig-zag arc " << zigzag_arc << std::endl;
-      if (zigzag_arc.value.is_invertible()) {
+    for (const Zigzag_& zigzag : zigzags) {
+      const Arc zigzag_arc(zigzag.source, zigzag.target, this->intern(zigzag.value));
+      if (zigzag.value.is_invertible()) {
         this->insert_arc(zigzag_arc);
       }
       else {
@@ -353,10 +498,18 @@ class Differential_suffix_forest : private Arc_container< Forest_options > {
     int target = reverse_arc_it->target;
     int source = reverse_arc_it->source;
     
-    erase_subtree_(greatest_single_child_ancestor_(target));
-    auto next_arc_it = erase_subtree_(greatest_single_child_ancestor_(source));
+    const int erased_target = greatest_single_child_ancestor_(target);
+    erase_subtree_(erased_target);
+    const int erased_source = greatest_single_child_ancestor_(source);
+    erase_subtree_(erased_source);
     
-    return next_arc_it;
+    // Arcs raised around the erased nodes may be merged back
+    if (Arc_merging::merge_raised_arcs) {
+      statistics.n_merged_arcs += merge_arcs_above_(erased_target);
+      statistics.n_merged_arcs += merge_arcs_above_(erased_source);
+    }
+    
+    return zigzags.size();
   }
   
   /* Given a critical arc, raise every arc below it to get critical and non-
@@ -376,8 +529,8 @@ class Differential_suffix_forest : private Arc_container< Forest_options > {
     this->template raise_arcs_below_node< Target >(critical_arc.target);
   }
   
-  /* Check if the a zig-zag concatenation is possible and add to a stream of
-   * new arcs.
+  /* Zig-zag arcs of all pairs of back and front arcs, in the order of back
+   * arcs, then front arcs.
    * 
    * Pre-conditions:
    * - back and front arcs are compatible with reverse arc
@@ -395,40 +548,92 @@ class Differential_suffix_forest : private Arc_container< Forest_options > {
    *     |      |         |       |               |              |
    *     *      *         *       *               *              *
    * 
-   * This will be used in homotopy reduction.
+   * A first pass over copies of the relevant endpoints and idempotents keeps
+   * the pairs whose positions and idempotents are compatible. The products of
+   * these pairs are then computed by blocks, on several threads if there are
+   * enough of them (see Reduction_parallelism.h).
    */
-  std::vector< Arc >& add_zigzag_(
-    std::vector< Arc >& arc_stream,
-    const Arc& back_arc,
+  std::vector< Zigzag_ > zigzags_(
+    const std::vector< Arc_reference >& back_arcs,
     const Arc& reverse_arc,
-    const Arc& front_arc
+    const std::vector< Arc_reference >& front_arcs
   ) const {
-    int source = back_arc.source;
-    int target = front_arc.target;
-    int back_diff = back_arc.target - reverse_arc.target;
-    int front_diff = front_arc.source - reverse_arc.source;
+    const int n_back = back_arcs.size();
+    const int n_front = front_arcs.size();
+    std::vector< int > back_diffs, back_sizes, front_diffs, front_sizes;
+    std::vector< Idem > back_idems, front_idems;
+    back_diffs.reserve(n_back);
+    back_sizes.reserve(n_back);
+    back_idems.reserve(n_back);
+    front_diffs.reserve(n_front);
+    front_sizes.reserve(n_front);
+    front_idems.reserve(n_front);
+    for (const Arc& back_arc : back_arcs) {
+      back_diffs.push_back(back_arc.target - reverse_arc.target);
+      back_sizes.push_back(this->descendants_size(back_arc.target));
+      back_idems.push_back(source_idem(back_arc));
+    }
+    for (const Arc& front_arc : front_arcs) {
+      front_diffs.push_back(front_arc.source - reverse_arc.source);
+      front_sizes.push_back(this->descendants_size(front_arc.source));
+      front_idems.push_back(target_idem(front_arc));
+    }
     
-    if (  // front is higher than back
-      back_diff <= front_diff
-      and front_diff < back_diff + this->descendants_size(back_arc.target)
-    ) {
-      if (source_idem(back_arc).too_far_from(target_idem(front_arc))) { return arc_stream; }
-      const Alg_el product = back_arc.value * front_arc.value;
-      if (product.is_null()) { return arc_stream; }
-      source += front_diff - back_diff;
-      arc_stream.emplace_back(source, target, product);
+    // First pass: compatible pairs
+    std::vector< Zigzag_pair_ > pairs;
+    for (int i = 0; i < n_back; ++i) {
+      for (int j = 0; j < n_front; ++j) {
+        const int difference = front_diffs[j] - back_diffs[i];
+        int source = back_arcs[i].get().source;
+        int target = front_arcs[j].get().target;
+        if (0 <= difference and difference < back_sizes[i]) {  // front is higher than back
+          source += difference;
+        }
+        else if (difference <= 0 and -difference < front_sizes[j]) {  // back is higher than front
+          target -= difference;
+        }
+        else {
+          continue;
+        }
+        if (back_idems[i].too_far_from(front_idems[j])) {
+          continue;
+        }
+        pairs.push_back({i, j, source, target});
+      }
     }
-    else if (  // back is higher than front
-      front_diff <= back_diff
-      and back_diff < front_diff + this->descendants_size(front_arc.source)
-    ) {
-      if (source_idem(back_arc).too_far_from(target_idem(front_arc))) { return arc_stream; }
-      const Alg_el product = back_arc.value * front_arc.value;
-      if (product.is_null()) { return arc_stream; }
-      target += back_diff - front_diff;
-      arc_stream.emplace_back(source, target, product);
+    
+    // Second pass: products, by blocks of consecutive pairs
+    const int n_pairs = pairs.size();
+    const int n_blocks = std::min(
+      Reduction_parallelism::n_threads(),
+      1 + n_pairs / Reduction_parallelism::min_products_per_thread
+    );
+    std::vector< std::vector< Zigzag_ > > blocks(n_blocks);
+    parallel_for(n_blocks, n_blocks, [&](int k) {
+      std::vector< Zigzag_ >& block = blocks[k];
+      for (
+        int p = static_cast< long >(n_pairs) * k / n_blocks;
+        p < static_cast< long >(n_pairs) * (k + 1) / n_blocks;
+        ++p
+      ) {
+        const Zigzag_pair_& pair = pairs[p];
+        Alg_el product = this->value(back_arcs[pair.back]) * this->value(front_arcs[pair.front]);
+        if (!product.is_null()) {
+          block.push_back({pair.source, pair.target, std::move(product)});
+        }
+      }
+    });
+    
+    std::vector< Zigzag_ > zigzags;
+    if (n_blocks == 1) {
+      zigzags.swap(blocks[0]);
+    }
+    else {
+      for (auto& block : blocks) {
+        std::move(block.begin(), block.end(), std::back_inserter(zigzags));
+      }
     }
-    return arc_stream;
+    return zigzags;
   }
   
   /* Return the greatest ancestor of a given node such that the ancestor only
@@ -448,6 +653,22 @@ class Differential_suffix_forest : private Arc_container< Forest_options > {
     return node;
   }
   
+  /* Merge arcs at the children of the strict ancestors of a node, from the
+   * parent up. Return the number of arcs removed by merging.
+   */
+  int merge_arcs_above_(int node) {
+    int n_removed = 0;
+    for (auto parent_it = ++this->ascender(node); parent_it.valid(); ++parent_it) {
+      const int n_merged_sources = this->template merge_arcs_at_children< Source >(*parent_it);
+      const int n_merged_targets = this->template merge_arcs_at_children< Target >(*parent_it);
+      if (n_merged_sources == 0 and n_merged_targets == 0) {
+        break;
+      }
+      n_removed += n_merged_sources + n_merged_targets;
+    }
+    return n_removed;
+  }
+  
   /* Erase all nodes and all arcs to and from above the given node. Return the
    * iterator to the first arc whose source is after the last deleted node.
    */
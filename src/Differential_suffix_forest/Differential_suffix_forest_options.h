@@ -28,6 +28,13 @@
 
 #include "Bordered_algebra/Bordered_algebra.h"
 #include "Bordered_algebra/Idempotent.h"
+#include "Bordered_algebra/U_weights_array.h"
+#include "Alg_el_storage.h"
+#include "Arc_merging.h"
+#include "Arc_storage.h"
+#include "Contraction_order.h"
+#include "Node_storage.h"
+#include "Reduction_parallelism.h"
 
 struct Forest_options_default_short {
   using Idem = Idempotent_short;
@@ -35,6 +42,13 @@ struct Forest_options_default_short {
   using Alg_el = typename Bordered_algebra::Element;
   using Gen_type = unsigned char;  // no need to pass by reference excessively
   using Weights = std::pair< int, int >;
+  using Node_storage = Contiguous_node_storage;
+  using Arc_storage = Multi_index_arc_storage;
+  using Arc_allocator = Standard_arc_allocator;
+  using Alg_el_storage = Direct_alg_el_storage;
+  using Contraction_order = Source_contraction_order;
+  using Reduction_parallelism = Serial_reduction;
+  using Arc_merging = No_arc_merging;
 };
 
 struct Forest_options_default_long {
@@ -43,6 +57,99 @@ struct Forest_options_default_long {
   using Alg_el = typename Bordered_algebra::Element;
   using Gen_type = unsigned char;  // no need to pass by reference excessively
   using Weights = std::pair< int, int >;
+  using Node_storage = Contiguous_node_storage;
+  using Arc_storage = Multi_index_arc_storage;
+  using Arc_allocator = Standard_arc_allocator;
+  using Alg_el_storage = Direct_alg_el_storage;
+  using Contraction_order = Source_contraction_order;
+  using Reduction_parallelism = Serial_reduction;
+  using Arc_merging = No_arc_merging;
+};
+
+/* Same as the defaults, but arcs are stored in a flat container (see
+ * Flat_arc_container.h).
+ */
+struct Forest_options_flat_short : Forest_options_default_short {
+  using Arc_storage = Flat_arc_storage;
+};
+
+struct Forest_options_flat_long : Forest_options_default_long {
+  using Arc_storage = Flat_arc_storage;
+};
+
+/* Same as the defaults, but forests share the nodes of old subtrees instead
+ * of copying them (see Node_storage.h).
+ */
+struct Forest_options_shared_short : Forest_options_default_short {
+  using Node_storage = Shared_node_storage;
+};
+
+struct Forest_options_shared_long : Forest_options_default_long {
+  using Node_storage = Shared_node_storage;
+};
+
+/* Same as the defaults, but identical subtrees of reduced forests share their
+ * nodes (see Node_storage.h).
+ */
+struct Forest_options_hash_consed_short : Forest_options_default_short {
+  using Node_storage = Hash_consed_node_storage;
+};
+
+struct Forest_options_hash_consed_long : Forest_options_default_long {
+  using Node_storage = Hash_consed_node_storage;
+};
+
+/* Same as the defaults, but the nodes of the arc trees come from a node pool
+ * (see Arc_storage.h).
+ */
+struct Forest_options_pooled_short : Forest_options_default_short {
+  using Arc_allocator = Pool_arc_allocator;
+};
+
+struct Forest_options_pooled_long : Forest_options_default_long {
+  using Arc_allocator = Pool_arc_allocator;
+};
+
+/* Same as the defaults, but arcs hold identifiers of hash-consed algebra
+ * elements (see Alg_el_storage.h).
+ */
+struct Forest_options_interned_short : Forest_options_default_short {
+  using Alg_el_storage = Interned_alg_el_storage;
+};
+
+struct Forest_options_interned_long : Forest_options_default_long {
+  using Alg_el_storage = Interned_alg_el_storage;
+};
+
+/* Same as the defaults, but zig-zag arcs are computed on all available
+ * threads (see Reduction_parallelism.h).
+ */
+struct Forest_options_parallel_short : Forest_options_default_short {
+  using Reduction_parallelism = Parallel_reduction<>;
+};
+
+struct Forest_options_parallel_long : Forest_options_default_long {
+  using Reduction_parallelism = Parallel_reduction<>;
+};
+
+/* Same as the defaults, but raised arcs are merged back into their parents
+ * (see Arc_merging.h).
+ */
+struct Forest_options_merged_short : Forest_options_default_short {
+  using Arc_merging = Raised_arc_merging;
+};
+
+struct Forest_options_merged_long : Forest_options_default_long {
+  using Arc_merging = Raised_arc_merging;
+};
+
+/* Same as the defaults, but U weights are stored inline (see
+ * U_weights_array.h). Short idempotents have at most 31 bits, hence at most 30
+ * strands.
+ */
+struct Forest_options_packed_short : Forest_options_default_short {
+  using Bordered_algebra = ::Bordered_algebra< Idem, U_weights_array< 32 > >;
+  using Alg_el = typename Bordered_algebra::Element;
 };
 
 #endif  // DIFFERENTIAL_SUFFIX_FOREST_OPTIONS_H_
\ No newline at end of file
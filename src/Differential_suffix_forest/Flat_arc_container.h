@@ -0,0 +1,765 @@
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *\
+ *                                                                           *
+ *  Bundled HFK - a knot Floer homology calculator                           *
+ *                                                                           *
+ *  Copyright (C) 2021-2022  Isaac Ren                                       *
+ *  For further details, contact Isaac Ren (gopi3.1415@gmail.com).           *
+ *                                                                           *
+ *  This program is free software: you can redistribute it and/or modify     *
+ *  it under the terms of the GNU General Public License as published by     *
+ *  the Free Software Foundation, either version 3 of the License, or        *
+ *  (at your option) any later version.                                      *
+ *                                                                           *
+ *  This program is distributed in the hope that it will be useful,          *
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of           *
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the            *
+ *  GNU General Public License for more details.                             *
+ *                                                                           *
+ *  You should have received a copy of the GNU General Public License        *
+ *  along with this program.  If not, see <https://www.gnu.org/licenses/>.   *
+ *                                                                           *
+\* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+
+#ifndef FLAT_ARC_CONTAINER_H_
+#define FLAT_ARC_CONTAINER_H_
+
+#include <algorithm>  // inplace_merge, lower_bound, stable_sort, upper_bound
+#include <cstddef>  // ptrdiff_t
+#include <deque>
+#include <iterator>
+#include <numeric>  // iota
+#include <type_traits>  // is_same
+#include <unordered_map>
+#include <utility>  // forward, move, pair
+#include <vector>
+
+/* Flat arc container.
+ * 
+ * This is a drop-in replacement for the boost multi-index container used by
+ * Arc_container, exposing the small part of its interface that we use: two
+ * ordered non-unique views, tagged Source and Target, with lower_bound,
+ * bidirectional iterators, emplace, erase and order-preserving modify.
+ * 
+ * Arcs live in one contiguous vector sorted by source, together with a
+ * permutation of that vector sorted by target. Both are rebuilt in bulk by
+ * consolidate(), which we call between the phases of the algorithm. Between
+ * two consolidations:
+ * - erased arcs are only marked as such, so that iterators and references to
+ * the remaining arcs stay valid;
+ * - inserted arcs go to a small pool, indexed by two sorted vectors, the
+ * buffers.
+ * Iterating over a view merges the contiguous storage with the corresponding
+ * buffer. Among arcs with equal keys, contiguous arcs come first, then
+ * buffered arcs in order of insertion, as in the multi-index container.
+ */
+template< class Arc, class Source, class Target >
+class Flat_arc_container;
+
+/* Types of the insertion buffers, separated from the container so that the
+ * views can name them.
+ */
+template< class Arc >
+struct Flat_arc_buffer {
+  struct Pooled_arc;
+  
+  /* Buffered arcs with equal keys are ordered by rank, that is, by order of
+   * insertion, so that a pooled arc is found in a buffer by bisection.
+   */
+  struct Buffered_arc {
+    int key;
+    int rank;
+    Pooled_arc* pooled_arc;
+    
+    bool operator<(const Buffered_arc& other) const {
+      return key < other.key or (key == other.key and rank < other.rank);
+    }
+  };
+  
+  using Buffer = std::vector< Buffered_arc >;
+  
+  struct Pooled_arc {
+    Pooled_arc(const Arc& a) : arc(a), rank(0) { }
+    
+    Arc arc;
+    int rank;
+  };
+};
+
+/* View on a flat arc container, ordered by the endpoint given by Tag.
+ */
+template< class Arc, class Source, class Target, class Tag >
+class Flat_arc_index {
+ public:
+  using Container = Flat_arc_container< Arc, Source, Target >;
+  using Buffer = typename Flat_arc_buffer< Arc >::Buffer;
+  using Buffer_iterator = typename Buffer::const_iterator;
+  using Pooled_arc = typename Flat_arc_buffer< Arc >::Pooled_arc;
+  
+  static constexpr bool by_source = std::is_same< Tag, Source >::value;
+  
+  static int key(const Arc& arc) {
+    return by_source ? arc.source : arc.target;
+  }
+  
+  struct key_from_value {
+    using result_type = int;
+    int operator()(const Arc& arc) const {
+      return key(arc);
+    }
+  };
+  
+  /* An iterator points either to a position of the contiguous storage or to
+   * a pooled arc. Only the current element is stored, not its position in the
+   * buffer: neighbors are found when moving, so that insertions in the
+   * buffers never invalidate it.
+   */
+  class iterator {
+   public:
+    using iterator_category = std::bidirectional_iterator_tag;
+    using value_type = Arc;
+    using difference_type = std::ptrdiff_t;
+    using pointer = const Arc*;
+    using reference = const Arc&;
+    
+    iterator() :
+      container_(nullptr),
+      in_main_(true),
+      main_pos_(0),
+      pooled_arc_(nullptr)
+    { }
+    
+    reference operator*() const {
+      return in_main_ ? container_->template main_arc_< Tag >(main_pos_)
+                      : pooled_arc_->arc;
+    }
+    
+    pointer operator->() const {
+      return &**this;
+    }
+    
+    iterator& operator++() {
+      if (in_main_) {
+        // buffered arcs with the same key come after all contiguous arcs
+        int current_key = container_->template main_key_< Tag >(main_pos_);
+        set_to_min_(
+          container_->template next_live_< Tag >(main_pos_ + 1),
+          buffer_lower_bound_(current_key)
+        );
+      }
+      else {
+        set_to_min_(
+          container_->template next_live_< Tag >(
+            container_->template main_upper_bound_< Tag >(key(pooled_arc_->arc))
+          ),
+          std::next(buffer_position_())
+        );
+      }
+      return *this;
+    }
+    
+    iterator operator++(int) {
+      iterator result = *this;
+      ++*this;
+      return result;
+    }
+    
+    iterator& operator--() {
+      if (in_main_) {
+        Buffer_iterator buffer_it = buffer_().end();
+        if (main_pos_ != container_->main_size_()) {
+          buffer_it = buffer_lower_bound_(
+            container_->template main_key_< Tag >(main_pos_)
+          );
+        }
+        set_to_max_(
+          container_->template prev_live_< Tag >(main_pos_ - 1),
+          buffer_it
+        );
+      }
+      else {
+        set_to_max_(
+          container_->template prev_live_< Tag >(
+            container_->template main_upper_bound_< Tag >(key(pooled_arc_->arc)) - 1
+          ),
+          buffer_position_()
+        );
+      }
+      return *this;
+    }
+    
+    iterator operator--(int) {
+      iterator result = *this;
+      --*this;
+      return result;
+    }
+    
+    bool operator==(const iterator& other) const {
+      if (in_main_ != other.in_main_) {
+        return false;
+      }
+      return in_main_ ? main_pos_ == other.main_pos_
+                      : pooled_arc_ == other.pooled_arc_;
+    }
+    
+    bool operator!=(const iterator& other) const {
+      return !(*this == other);
+    }
+   
+   private:
+    friend class Flat_arc_index;
+    friend class Flat_arc_container< Arc, Source, Target >;
+    
+    const Buffer& buffer_() const {
+      return container_->template buffer_< Tag >();
+    }
+    
+    Buffer_iterator buffer_lower_bound_(int k) const {
+      return container_->template buffer_lower_bound_< Tag >(k);
+    }
+    
+    Buffer_iterator buffer_position_() const {
+      return container_->template buffer_position_< Tag >(pooled_arc_);
+    }
+    
+    /* Point to the first of a live position and a buffered arc. */
+    void set_to_min_(int main_pos, Buffer_iterator buffer_it) {
+      if (
+        buffer_it == buffer_().end()
+        or (
+          main_pos != container_->main_size_()
+          and container_->template main_key_< Tag >(main_pos) <= buffer_it->key
+        )
+      ) {
+        in_main_ = true;
+        main_pos_ = main_pos;
+      }
+      else {
+        in_main_ = false;
+        pooled_arc_ = buffer_it->pooled_arc;
+      }
+    }
+    
+    /* Point to the last of a live position (-1 if none) and the buffered arc
+     * preceding buffer_it.
+     */
+    void set_to_max_(int main_pos, Buffer_iterator buffer_it) {
+      if (
+        buffer_it != buffer_().begin()
+        and (
+          main_pos < 0
+          or std::prev(buffer_it)->key
+             >= container_->template main_key_< Tag >(main_pos)
+        )
+      ) {
+        in_main_ = false;
+        pooled_arc_ = std::prev(buffer_it)->pooled_arc;
+      }
+      else {
+        in_main_ = true;
+        main_pos_ = main_pos;
+      }
+    }
+    
+    Container* container_;
+    bool in_main_;
+    int main_pos_;
+    Pooled_arc* pooled_arc_;
+  };
+  
+  using const_iterator = iterator;
+  
+  explicit Flat_arc_index(Container* container) : container_(container) { }
+  
+  Flat_arc_index(const Flat_arc_index&) = delete;
+  Flat_arc_index& operator=(const Flat_arc_index&) = delete;
+  
+  /* OBSERVERS */
+  
+  iterator begin() const {
+    return min_iterator_(
+      container_->template next_live_< Tag >(0),
+      buffer_().begin()
+    );
+  }
+  
+  iterator end() const {
+    iterator result;
+    result.container_ = container_;
+    result.main_pos_ = container_->main_size_();
+    return result;
+  }
+  
+  iterator lower_bound(int k) const {
+    return min_iterator_(
+      container_->template next_live_< Tag >(
+        container_->template main_lower_bound_< Tag >(k)
+      ),
+      container_->template buffer_lower_bound_< Tag >(k)
+    );
+  }
+  
+  key_from_value key_extractor() const {
+    return key_from_value();
+  }
+  
+  std::size_t size() const {
+    return container_->size_;
+  }
+  
+  bool empty() const {
+    return container_->size_ == 0;
+  }
+  
+  /* MODIFIERS */
+  
+  template< class... Args >
+  std::pair< iterator, bool > emplace(Args&&... args) {
+    auto pooled_arc = container_->new_pooled_arc_(Arc(std::forward< Args >(args)...));
+    iterator result;
+    result.container_ = container_;
+    result.in_main_ = false;
+    result.pooled_arc_ = pooled_arc;
+    return std::make_pair(result, true);
+  }
+  
+  std::pair< iterator, bool > insert(const Arc& arc) {
+    return emplace(arc);
+  }
+  
+  iterator erase(iterator position) {
+    iterator next = std::next(position);
+    if (position.in_main_) {
+      container_->erase_main_(container_->template main_index_< Tag >(position.main_pos_));
+    }
+    else {
+      container_->erase_pooled_(position.pooled_arc_);
+    }
+    return next;
+  }
+  
+  iterator erase(iterator first, iterator last) {
+    while (first != last) {
+      first = erase(first);
+    }
+    return first;
+  }
+  
+  /* The modification must preserve the order of arcs in both views. */
+  template< class Modifier >
+  bool modify(iterator position, Modifier modifier) {
+    if (position.in_main_) {
+      modifier(container_->sorted_arcs_[container_->template main_index_< Tag >(position.main_pos_)]);
+    }
+    else {
+      container_->modify_pooled_(position.pooled_arc_, modifier);
+    }
+    return true;
+  }
+ 
+ private:
+  const Buffer& buffer_() const {
+    return container_->template buffer_< Tag >();
+  }
+  
+  iterator min_iterator_(int main_pos, Buffer_iterator buffer_it) const {
+    iterator result;
+    result.container_ = container_;
+    result.set_to_min_(main_pos, buffer_it);
+    return result;
+  }
+ 
+ protected:
+  Container* container_;
+};
+
+template< class Arc, class Source, class Target >
+class Flat_arc_container : public Flat_arc_index< Arc, Source, Target, Source > {
+ public:
+  using Source_index = Flat_arc_index< Arc, Source, Target, Source >;
+  using Target_index = Flat_arc_index< Arc, Source, Target, Target >;
+  
+  template< class Tag >
+  struct index {
+    using type = Flat_arc_index< Arc, Source, Target, Tag >;
+  };
+  
+  using iterator = typename Source_index::iterator;
+  using const_iterator = iterator;
+  
+  Flat_arc_container() :
+    Source_index(this),
+    target_index_(this),
+    n_rank_(0),
+    n_erased_(0),
+    size_(0)
+  { }
+  
+  Flat_arc_container(const Flat_arc_container& other) :
+    Source_index(this),
+    target_index_(this),
+    n_rank_(0),
+    n_erased_(0),
+    size_(0)
+  {
+    other.flatten_(sorted_arcs_, by_target_, (const Arc*)nullptr, (const Arc*)nullptr);
+    reset_();
+  }
+  
+  Flat_arc_container(Flat_arc_container&& other) :
+    Flat_arc_container()
+  {
+    swap(other);
+  }
+  
+  Flat_arc_container& operator=(Flat_arc_container other) {
+    swap(other);
+    return *this;
+  }
+  
+  /* Swapping standard containers keeps iterators and pointers to their
+   * elements valid, so the pool and the buffers can be exchanged as is.
+   */
+  void swap(Flat_arc_container& other) {
+    sorted_arcs_.swap(other.sorted_arcs_);
+    erased_.swap(other.erased_);
+    by_target_.swap(other.by_target_);
+    pool_.swap(other.pool_);
+    free_pooled_arcs_.swap(other.free_pooled_arcs_);
+    source_buffer_.swap(other.source_buffer_);
+    target_buffer_.swap(other.target_buffer_);
+    std::swap(n_rank_, other.n_rank_);
+    std::swap(n_erased_, other.n_erased_);
+    std::swap(size_, other.size_);
+  }
+  
+  template< class Tag >
+  typename index< Tag >::type& get() {
+    return index_(Tag());
+  }
+  
+  template< class Tag >
+  const typename index< Tag >::type& get() const {
+    return index_(Tag());
+  }
+  
+  using Source_index::insert;
+  
+  /* Bulk insertion, followed by consolidation. As in the multi-index
+   * container, new arcs come after existing arcs with the same key.
+   */
+  template< class Iterator >
+  void insert(Iterator first, Iterator last) {
+    std::vector< Arc > sorted_arcs;
+    std::vector< int > by_target;
+    flatten_(sorted_arcs, by_target, first, last);
+    sorted_arcs_.swap(sorted_arcs);
+    by_target_.swap(by_target);
+    reset_();
+  }
+  
+  void clear() {
+    sorted_arcs_.clear();
+    by_target_.clear();
+    reset_();
+  }
+  
+  /* Move buffered arcs to the contiguous storage and forget erased arcs.
+   * This invalidates all iterators and references.
+   */
+  void consolidate() {
+    if (pool_.empty() and n_erased_ == 0) {
+      return;
+    }
+    insert((const Arc*)nullptr, (const Arc*)nullptr);
+  }
+  
+  /* Number of buffered and erased arcs, that is, the work left for the next
+   * consolidation.
+   */
+  std::size_t n_pending() const {
+    return (pool_.size() - free_pooled_arcs_.size()) + n_erased_;
+  }
+ 
+ private:
+  template< class A, class S, class T, class G >
+  friend class Flat_arc_index;
+  
+  using Buffered_arc = typename Flat_arc_buffer< Arc >::Buffered_arc;
+  using Buffer = typename Flat_arc_buffer< Arc >::Buffer;
+  using Buffer_iterator = typename Buffer::const_iterator;
+  using Pooled_arc = typename Flat_arc_buffer< Arc >::Pooled_arc;
+  
+  Source_index& index_(Source) {
+    return *this;
+  }
+  
+  const Source_index& index_(Source) const {
+    return *this;
+  }
+  
+  Target_index& index_(Target) {
+    return target_index_;
+  }
+  
+  const Target_index& index_(Target) const {
+    return target_index_;
+  }
+  
+  template< class Tag >
+  const Buffer& buffer_() const {
+    return std::is_same< Tag, Source >::value ? source_buffer_ : target_buffer_;
+  }
+  
+  /* Ranks are nonnegative, so this is the first buffered arc of key at
+   * least k.
+   */
+  template< class Tag >
+  Buffer_iterator buffer_lower_bound_(int k) const {
+    const Buffer& buffer = buffer_< Tag >();
+    return std::lower_bound(buffer.begin(), buffer.end(), Buffered_arc{ k, -1, nullptr });
+  }
+  
+  template< class Tag >
+  Buffer_iterator buffer_position_(const Pooled_arc* pooled_arc) const {
+    const Buffer& buffer = buffer_< Tag >();
+    return std::lower_bound(
+      buffer.begin(),
+      buffer.end(),
+      Buffered_arc{ index< Tag >::type::key(pooled_arc->arc), pooled_arc->rank, nullptr }
+    );
+  }
+  
+  /* Positions in a view are indices of the contiguous storage, possibly
+   * permuted by by_target_.
+   */
+  int main_size_() const {
+    return sorted_arcs_.size();
+  }
+  
+  template< class Tag >
+  int main_index_(int main_pos) const {
+    return std::is_same< Tag, Source >::value ? main_pos : by_target_[main_pos];
+  }
+  
+  template< class Tag >
+  const Arc& main_arc_(int main_pos) const {
+    return sorted_arcs_[main_index_< Tag >(main_pos)];
+  }
+  
+  template< class Tag >
+  int main_key_(int main_pos) const {
+    return index< Tag >::type::key(main_arc_< Tag >(main_pos));
+  }
+  
+  template< class Tag >
+  int next_live_(int main_pos) const {
+    while (main_pos != main_size_() and erased_[main_index_< Tag >(main_pos)]) {
+      ++main_pos;
+    }
+    return main_pos;
+  }
+  
+  template< class Tag >
+  int prev_live_(int main_pos) const {
+    while (main_pos >= 0 and erased_[main_index_< Tag >(main_pos)]) {
+      --main_pos;
+    }
+    return main_pos;
+  }
+  
+  /* Erased arcs keep their keys, so we may bisect over all positions. */
+  template< class Tag >
+  int main_lower_bound_(int k) const {
+    int first = 0;
+    int count = main_size_();
+    while (count > 0) {
+      int step = count / 2;
+      if (main_key_< Tag >(first + step) < k) {
+        first += step + 1;
+        count -= step + 1;
+      }
+      else {
+        count = step;
+      }
+    }
+    return first;
+  }
+  
+  template< class Tag >
+  int main_upper_bound_(int k) const {
+    return main_lower_bound_< Tag >(k + 1);
+  }
+  
+  Pooled_arc* new_pooled_arc_(const Arc& arc) {
+    Pooled_arc* pooled_arc;
+    if (free_pooled_arcs_.empty()) {
+      pool_.emplace_back(arc);
+      pooled_arc = &pool_.back();
+    }
+    else {
+      pooled_arc = free_pooled_arcs_.back();
+      free_pooled_arcs_.pop_back();
+      pooled_arc->arc = arc;
+    }
+    // the rank is the largest so far, so the arc goes after those of equal key
+    pooled_arc->rank = n_rank_++;
+    Buffered_arc in_source_buffer{ arc.source, pooled_arc->rank, pooled_arc };
+    Buffered_arc in_target_buffer{ arc.target, pooled_arc->rank, pooled_arc };
+    source_buffer_.insert(
+      std::upper_bound(source_buffer_.begin(), source_buffer_.end(), in_source_buffer),
+      in_source_buffer
+    );
+    target_buffer_.insert(
+      std::upper_bound(target_buffer_.begin(), target_buffer_.end(), in_target_buffer),
+      in_target_buffer
+    );
+    ++size_;
+    return pooled_arc;
+  }
+  
+  void erase_main_(int main_index) {
+    erased_[main_index] = true;
+    ++n_erased_;
+    --size_;
+  }
+  
+  void erase_pooled_(Pooled_arc* pooled_arc) {
+    source_buffer_.erase(buffer_position_< Source >(pooled_arc));
+    target_buffer_.erase(buffer_position_< Target >(pooled_arc));
+    free_pooled_arcs_.push_back(pooled_arc);
+    --size_;
+  }
+  
+  /* The buffers stay sorted, because the modification preserves the order of
+   * arcs in both views.
+   */
+  template< class Modifier >
+  void modify_pooled_(Pooled_arc* pooled_arc, Modifier modifier) {
+    auto in_source_buffer = source_buffer_.begin()
+      + (buffer_position_< Source >(pooled_arc) - source_buffer_.cbegin());
+    auto in_target_buffer = target_buffer_.begin()
+      + (buffer_position_< Target >(pooled_arc) - target_buffer_.cbegin());
+    modifier(pooled_arc->arc);
+    in_source_buffer->key = pooled_arc->arc.source;
+    in_target_buffer->key = pooled_arc->arc.target;
+  }
+  
+  /* Call f(arc, main_index, pooled_arc) on every live arc in the order of
+   * the view given by Tag. Exactly one of main_index and pooled_arc is valid;
+   * the other is -1 or nullptr.
+   */
+  template< class Tag, class Function >
+  void for_each_(Function f) const {
+    const Buffer& buffer = buffer_< Tag >();
+    auto buffer_it = buffer.begin();
+    for (int main_pos = 0; main_pos != main_size_(); ++main_pos) {
+      int main_index = main_index_< Tag >(main_pos);
+      if (erased_[main_index]) {
+        continue;
+      }
+      const Arc& arc = sorted_arcs_[main_index];
+      int k = index< Tag >::type::key(arc);
+      for (; buffer_it != buffer.end() and buffer_it->key < k; ++buffer_it) {
+        f(buffer_it->pooled_arc->arc, -1, buffer_it->pooled_arc);
+      }
+      f(arc, main_index, (const Pooled_arc*)nullptr);
+    }
+    for (; buffer_it != buffer.end(); ++buffer_it) {
+      f(buffer_it->pooled_arc->arc, -1, buffer_it->pooled_arc);
+    }
+  }
+  
+  /* Compute the contiguous storage and target permutation of the live arcs,
+   * followed by the arcs in [first, last).
+   */
+  template< class Iterator >
+  void flatten_(
+    std::vector< Arc >& sorted_arcs,
+    std::vector< int >& by_target,
+    Iterator first,
+    Iterator last
+  ) const {
+    std::vector< Arc > arcs;
+    arcs.reserve(size_ + std::distance(first, last));
+    std::vector< int > main_id(sorted_arcs_.size(), -1);
+    std::unordered_map< const Pooled_arc*, int > pooled_id;
+    
+    for_each_< Source >([&](const Arc& arc, int main_index, const Pooled_arc* pooled_arc) {
+      if (pooled_arc == nullptr) {
+        main_id[main_index] = arcs.size();
+      }
+      else {
+        pooled_id[pooled_arc] = arcs.size();
+      }
+      arcs.push_back(arc);
+    });
+    const int n_old = arcs.size();
+    arcs.insert(arcs.end(), first, last);
+    const int n_arcs = arcs.size();
+    
+    // Stable merges, so that old arcs precede new arcs with the same key.
+    auto source_less = [&](int i, int j) { return arcs[i].source < arcs[j].source; };
+    auto target_less = [&](int i, int j) { return arcs[i].target < arcs[j].target; };
+    
+    std::vector< int > source_order(n_arcs);
+    std::iota(source_order.begin(), source_order.end(), 0);
+    std::stable_sort(source_order.begin() + n_old, source_order.end(), source_less);
+    std::inplace_merge(source_order.begin(), source_order.begin() + n_old,
+                       source_order.end(), source_less);
+    
+    std::vector< int > target_order;
+    target_order.reserve(n_arcs);
+    for_each_< Target >([&](const Arc&, int main_index, const Pooled_arc* pooled_arc) {
+      target_order.push_back(
+        pooled_arc == nullptr ? main_id[main_index] : pooled_id[pooled_arc]
+      );
+    });
+    for (int id = n_old; id != n_arcs; ++id) {
+      target_order.push_back(id);
+    }
+    std::stable_sort(target_order.begin() + n_old, target_order.end(), target_less);
+    std::inplace_merge(target_order.begin(), target_order.begin() + n_old,
+                       target_order.end(), target_less);
+    
+    std::vector< int > position(n_arcs);
+    sorted_arcs.clear();
+    sorted_arcs.reserve(n_arcs);
+    for (int pos = 0; pos != n_arcs; ++pos) {
+      position[source_order[pos]] = pos;
+      sorted_arcs.push_back(std::move(arcs[source_order[pos]]));
+    }
+    by_target.resize(n_arcs);
+    for (int pos = 0; pos != n_arcs; ++pos) {
+      by_target[pos] = position[target_order[pos]];
+    }
+  }
+  
+  /* Drop buffers and marks after the contiguous storage has been replaced. */
+  void reset_() {
+    erased_.assign(sorted_arcs_.size(), false);
+    pool_.clear();
+    free_pooled_arcs_.clear();
+    source_buffer_.clear();
+    target_buffer_.clear();
+    n_rank_ = 0;
+    n_erased_ = 0;
+    size_ = sorted_arcs_.size();
+  }
+  
+  Target_index target_index_;
+  
+  std::vector< Arc > sorted_arcs_;  // sorted by source
+  std::vector< bool > erased_;  // indexed like sorted_arcs_
+  std::vector< int > by_target_;  // indices of sorted_arcs_, sorted by target
+  
+  std::deque< Pooled_arc > pool_;  // stable addresses
+  std::vector< Pooled_arc* > free_pooled_arcs_;
+  Buffer source_buffer_;  // sorted
+  Buffer target_buffer_;  // sorted
+  
+  int n_rank_;  // number of insertions since the last consolidation
+  int n_erased_;
+  int size_;
+};
+
+#endif  // FLAT_ARC_CONTAINER_H_
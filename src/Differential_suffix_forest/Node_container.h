@@ -23,10 +23,15 @@
 #ifndef NODE_CONTAINER_H_
 #define NODE_CONTAINER_H_
 
+#include <algorithm>  // max, min
+#include <cstddef>  // size_t
 #include <map>
 #include <string>
+#include <unordered_map>
 #include <vector>
 
+#include <boost/functional/hash.hpp>  // hash_combine
+
 #include "Differential_suffix_forest_options.h"
 
 /* Node container
@@ -78,6 +83,17 @@ class Node_container {
     std::string label;
 #endif  // BUNDLED_HFK_DRAW_
         
+    bool operator==(const Node& other) const {
+      return (to_parent == other.to_parent
+              and to_next == other.to_next
+              and descendants_size == other.descendants_size
+              and weights == other.weights
+#ifdef BUNDLED_HFK_DRAW_
+              and label == other.label
+#endif  // BUNDLED_HFK_DRAW_
+              );
+    }
+    
     friend std::ostream& operator<<(std::ostream& os, const Node& node) {
       os << "<"
          << node.to_parent
@@ -92,6 +108,9 @@ class Node_container {
     }
   };
   
+  using Node_storage = typename Forest_options::Node_storage;
+  using Node_storage_container = typename Node_storage::template Container< Node >;
+  
   /* An iterator for parents: this satisfies C++'s LegacyIterator requirements.
    */
   class Ascender {
@@ -200,10 +219,24 @@ class Node_container {
     return Ascender(node, *this);
   }
   
-  /* Other observers, any cost */
+  /* Whether a node is an ancestor of another node, or the node itself.
+   * Erasing a subtree only extends the ranges of other nodes over erased
+   * nodes, so this holds for nodes that are not erased.
+   */
+  bool is_ancestor(int ancestor, int node) const {
+    return ancestor <= node and node < descendants_end(ancestor);
+  }
+  
+  /* Ancestor index
+   * 
+   * The root, the depth and the sum of the weights from the root of every
+   * node, so that these are answered without walking up to the root. Nodes
+   * do not move and their ancestors do not change until the next pruning,
+   * so the index is built when generators are locked, and after pruning.
+   */
   
   int root(int i) const {
-    return (--root_idems_.upper_bound(i))->first;
+    return roots_[i];
   }
   
   /* Distance from a node to its root. Only used when declaring arcs
@@ -212,6 +245,39 @@ class Node_container {
     return i - root(i);
   }
   
+  /* Number of strict ancestors of a node. */
+  int depth(int node) const {
+    return depths_[node];
+  }
+  
+  /* Sum of the weights of a node and its ancestors. For a leaf, these are the
+   * weights of the generator.
+   */
+  Weights generator_weights(int node) const {
+    return path_weights_[node];
+  }
+  
+  void build_ancestor_index() {
+    roots_.resize(nodes_.size());
+    depths_.resize(nodes_.size());
+    path_weights_.resize(nodes_.size());
+    for (int i = 0; i != nodes_.size(); ++i) {
+      if (is_root(i)) {
+        roots_[i] = i;
+        depths_[i] = 0;
+        path_weights_[i] = weights(i);
+      }
+      else {
+        roots_[i] = roots_[parent(i)];
+        depths_[i] = depths_[parent(i)] + 1;
+        path_weights_[i].first = path_weights_[parent(i)].first + weights(i).first;
+        path_weights_[i].second = path_weights_[parent(i)].second + weights(i).second;
+      }
+    }
+  }
+  
+  /* Other observers, any cost */
+  
   int last_child(int i) const {
     int result = 0;
     for (int child = descendants_begin(i);
@@ -253,30 +319,32 @@ class Node_container {
   ) {
     int new_child = nodes_.size();
     int subtree_size = old_nodes.descendants_size(old_subroot);
-    nodes_.emplace_back(new_child - new_subroot, 1, subtree_size, new_weights
+    nodes_.push_back(Node(new_child - new_subroot, 1, subtree_size, new_weights
 #ifdef BUNDLED_HFK_DRAW_
     , new_label
 #endif  // BUNDLED_HFK_DRAW_
-    );
-    nodes_.insert(
-      nodes_.end(),
-      old_nodes.nodes_.begin() + old_subroot + 1,
-      old_nodes.nodes_.begin() + old_subroot + subtree_size
-    );
-    nodes_[new_subroot].descendants_size += subtree_size;
+    ));
+    nodes_.append(old_nodes.nodes_, old_subroot + 1, old_subroot + subtree_size);
+    nodes_.modify(new_subroot).descendants_size += subtree_size;
     return new_child;
   }
   
+  /* Erase a subtree by extending the range of the previous sibling or root,
+   * or of the parent if the subtree is the first child. The first remaining
+   * root has no previous root: it is not always 0, since roots before it may
+   * have been erased already, depending on the contraction order.
+   */
   void erase_subtree_nodes(const int subroot) {
-    if (subroot == 0) {
-      root_idems_.erase(0);
+    if (subroot == root_idems_.begin()->first) {
+      root_idems_.erase(root_idems_.begin());
     }
     else if (is_root(subroot)) {
       root_idems_.erase(subroot);
-      increase_right_edge_(root(subroot), descendants_size(subroot));
+      const int previous_root = (--root_idems_.upper_bound(subroot))->first;
+      increase_right_edge_(previous_root, descendants_size(subroot));
     }
     else if (is_first_child(subroot)) {
-      nodes_[parent(subroot)].to_next += descendants_size(subroot);
+      nodes_.modify(parent(subroot)).to_next += descendants_size(subroot);
     }
     else {  // other child
       int child = descendants_begin(parent(subroot));
@@ -294,18 +362,22 @@ class Node_container {
   void clear_nodes() {
     nodes_.clear();
     root_idems_.clear();
+    roots_.clear();
+    depths_.clear();
+    path_weights_.clear();
   }
   
  private:
   void increase_right_edge_(const int node, const int offset) {
     if (has_children(node)) {
       int child = last_child(node);
-      nodes_[node].descendants_size += offset;
+      nodes_.modify(node).descendants_size += offset;
       increase_right_edge_(child, offset);
     }
     else {
-      nodes_[node].descendants_size += offset;
-      nodes_[node].to_next += offset;
+      Node& modified_node = nodes_.modify(node);
+      modified_node.descendants_size += offset;
+      modified_node.to_next += offset;
     }
   }
   
@@ -327,23 +399,24 @@ class Node_container {
   }
   
   void prune_nodes(const std::vector< int >& offsets) {
-    std::vector< Node > new_nodes;
+    Node_storage_container& new_nodes = pruned_nodes_;
+    new_nodes.clear();
     Root_handle_container new_root_idems;
     
     for (int i = 0; i != nodes_.size(); ++i) {
       if (offsets[i] >= 0) {
         if (is_root(i)) {
           new_root_idems[new_nodes.size()] = root_idems_[i];
-          new_nodes.emplace_back(0, 1,
+          new_nodes.push_back(Node(0, 1,
             descendants_size(i) + offsets[i] - offsets[descendants_end(i)],
             weights(i)
 #ifdef BUNDLED_HFK_DRAW_
             , label(i)
 #endif  // BUNDLED_HFK_DRAW_
-          );
+          ));
         }
         else {
-          new_nodes.emplace_back(
+          new_nodes.push_back(Node(
             to_parent(i) - offsets[i] + offsets[parent(i)],
             1,
             descendants_size(i) + offsets[i] - offsets[descendants_end(i)],
@@ -351,57 +424,160 @@ class Node_container {
 #ifdef BUNDLED_HFK_DRAW_
             , label(i)
 #endif  // BUNDLED_HFK_DRAW_
-          );
+          ));
         }
       }
     }
     
     nodes_.swap(new_nodes);
+    new_nodes.clear();
     root_idems_.swap(new_root_idems);
   }
   
-  /* Poincaré polynomial stuff */
+  /* Subtree sharing stuff
+   * 
+   * Hash the descendants of every node, from the leaves up. When the
+   * descendants of a node are identical to those of an earlier node, they are
+   * repeated from the earlier node instead of being copied (see
+   * Node_storage.h), and their own descendants are not looked at. Positions
+   * do not change, so arcs are not affected. Return the number of repeated
+   * nodes.
+   * 
+   * Pre-condition: pruned nodes.
+   */
+  int share_identical_subtrees() {
+    std::vector< std::size_t > subtree_hashes(nodes_.size());
+    std::vector< std::size_t > descendants_hashes(nodes_.size());
+    for (int i = nodes_.size() - 1; i >= 0; --i) {
+      std::size_t seed = 0;
+      for (
+        int child = descendants_begin(i);
+        child != descendants_end(i);
+        child += descendants_size(child)
+      ) {
+        boost::hash_combine(seed, subtree_hashes[child]);
+      }
+      descendants_hashes[i] = seed;
+      boost::hash_combine(seed, weights(i).first);
+      boost::hash_combine(seed, weights(i).second);
+      subtree_hashes[i] = seed;
+    }
+    
+    Node_storage_container& new_nodes = pruned_nodes_;
+    new_nodes.clear();
+    std::unordered_map< std::size_t, int > first_nodes;
+    int n_repeated = 0;
+    
+    for (int i = 0; i != nodes_.size();) {
+      new_nodes.push_back(nodes_[i]);
+      if (has_children(i)) {
+        auto first_node_it = first_nodes.find(descendants_hashes[i]);
+        if (first_node_it == first_nodes.end()) {
+          first_nodes.emplace(descendants_hashes[i], i);
+        }
+        else if (same_descendants_(first_node_it->second, i)) {
+          const int first_node = first_node_it->second;
+          new_nodes.repeat(first_node + 1, descendants_end(first_node));
+          n_repeated += descendants_size(i) - 1;
+          i = descendants_end(i);
+          continue;
+        }
+      }
+      ++i;
+    }
+    
+    nodes_.swap(new_nodes);
+    new_nodes.clear();
+    return n_repeated;
+  }
+ 
+ private:
+  bool same_descendants_(int node, int other_node) const {
+    if (descendants_size(node) != descendants_size(other_node)) {
+      return false;
+    }
+    for (int k = 1; k != descendants_size(node); ++k) {
+      if (!(nodes_[node + k] == nodes_[other_node + k])) {
+        return false;
+      }
+    }
+    return true;
+  }
+ 
+ public:
+  /* Poincaré polynomial stuff
+   * 
+   * The grading of a generator is the sum of the weights of the strict
+   * ancestors of its leaf, given by the ancestor index. Generators are counted
+   * in a dense histogram over the box of their gradings, in one sweep over
+   * the leaves above the root, and the polynomial is read off the histogram
+   * in increasing order of monomials. If leaf_gradings is given, it receives
+   * the gradings of the generators, in preorder.
+   */
   
   template< class Polynomial >
-  Polynomial poincare_polynomial(const Idem& idem = Idem("0")) const {
+  Polynomial poincare_polynomial(
+    const Idem& idem = Idem("0"),
+    std::vector< Weights >* leaf_gradings = nullptr
+  ) const {
     // find root with given idempotent
     for (const auto& value_pair : root_idems_) {
       if (value_pair.second == idem) {
-        return poincare_polynomial_at_< Polynomial >(value_pair.first);
+        return poincare_polynomial_at_< Polynomial >(value_pair.first, leaf_gradings);
       }
     }
     return Polynomial(0);
   }
   
-  Weights generator_weights(int leaf) const {
-    Weights weights = {0, 0};
-    for (auto node_it = ascender(leaf); node_it.valid(); ++node_it) {
-      Weights new_weights = this->weights(*node_it);
-      weights.first += new_weights.first;
-      weights.second += new_weights.second;
-    }
-    return weights;
+ private:
+  Weights leaf_grading_(const int leaf) const {
+    return {path_weights_[leaf].first - weights(leaf).first,
+            path_weights_[leaf].second - weights(leaf).second};
   }
   
- private:
   template< class Polynomial >
-  Polynomial poincare_polynomial_at_(const int node) const {
-    if (!has_children(node)) {
-      return Polynomial(1);
+  Polynomial poincare_polynomial_at_(
+    const int root,
+    std::vector< Weights >* leaf_gradings
+  ) const {
+    if (leaf_gradings) {
+      leaf_gradings->clear();
     }
-    else {
-      Polynomial poly = 0;
-      for (
-        int child = descendants_begin(node);
-        child != descendants_end(node);
-        child += descendants_size(child)
-      ) {
-        Polynomial child_poly = poincare_polynomial_at_< Polynomial >(child);
-        child_poly *= weights(node);
-        poly += child_poly;
+    Weights min_grading = leaf_grading_(root);
+    Weights max_grading = min_grading;
+    for (int node = root; node != descendants_end(root); node = next(node)) {
+      if (!has_children(node)) {
+        const Weights grading = leaf_grading_(node);
+        min_grading.first = std::min(min_grading.first, grading.first);
+        min_grading.second = std::min(min_grading.second, grading.second);
+        max_grading.first = std::max(max_grading.first, grading.first);
+        max_grading.second = std::max(max_grading.second, grading.second);
+        if (leaf_gradings) {
+          leaf_gradings->push_back(grading);
+        }
+      }
+    }
+    
+    const int width = max_grading.second - min_grading.second + 1;
+    std::vector< int > histogram(
+      (max_grading.first - min_grading.first + 1) * width, 0);
+    for (int node = root; node != descendants_end(root); node = next(node)) {
+      if (!has_children(node)) {
+        const Weights grading = leaf_grading_(node);
+        ++histogram[(grading.first - min_grading.first) * width
+                    + grading.second - min_grading.second];
       }
-      return poly;
     }
+    
+    Polynomial poly = 0;
+    for (int k = 0; k != histogram.size(); ++k) {
+      if (histogram[k] != 0) {
+        Polynomial term = histogram[k];
+        term *= Weights(min_grading.first + k / width, min_grading.second + k % width);
+        poly += term;
+      }
+    }
+    return poly;
   }
   
  public:
@@ -530,9 +706,15 @@ class Node_container {
 #endif  // BUNDLED_HFK_DRAW_
   
  protected:
-  std::vector< Node > nodes_;
+  Node_storage_container nodes_;
+  Node_storage_container pruned_nodes_;  // keeps its capacity between prunings
   
   Root_handle_container root_idems_;
+  
+  // Ancestor index, see build_ancestor_index
+  std::vector< int > roots_;
+  std::vector< int > depths_;
+  std::vector< Weights > path_weights_;
 };
 
 #endif  // NODE_CONTAINER_H_
\ No newline at end of file
@@ -0,0 +1,370 @@
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *\
+ *                                                                           *
+ *  Bundled HFK - a knot Floer homology calculator                           *
+ *                                                                           *
+ *  Copyright (C) 2021-2022  Isaac Ren                                       *
+ *  For further details, contact Isaac Ren (gopi3.1415@gmail.com).           *
+ *                                                                           *
+ *  This program is free software: you can redistribute it and/or modify     *
+ *  it under the terms of the GNU General Public License as published by     *
+ *  the Free Software Foundation, either version 3 of the License, or        *
+ *  (at your option) any later version.                                      *
+ *                                                                           *
+ *  This program is distributed in the hope that it will be useful,          *
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of           *
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the            *
+ *  GNU General Public License for more details.                             *
+ *                                                                           *
+ *  You should have received a copy of the GNU General Public License        *
+ *  along with this program.  If not, see <https://www.gnu.org/licenses/>.   *
+ *                                                                           *
+\* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+
+#ifndef NODE_STORAGE_H_
+#define NODE_STORAGE_H_
+
+#include <algorithm>  // find, max, min, upper_bound
+#include <cstddef>  // size_t
+#include <memory>  // make_shared, shared_ptr
+#include <utility>  // swap
+#include <vector>
+
+#include <boost/iterator/iterator_facade.hpp>
+
+/* Node storage policies.
+ * 
+ * A node storage policy tells Node_container how to store nodes. It provides
+ * a container template, indexed by preorder position, with:
+ * - size(), operator[], begin() and end(), read-only;
+ * - modify(), giving a reference to a node that is about to change;
+ * - push_back(), clear() and swap();
+ * - append(), adding a range of nodes of another container at the end;
+ * - repeat(), adding a range of its own nodes at the end;
+ * - share_identical_subtrees, whether reduced forests look for identical
+ *   subtrees and repeat them (see Node_container::share_identical_subtrees).
+ * 
+ * Nodes only hold relative distances, so the nodes of a subtree do not
+ * depend on where the subtree lies.
+ */
+
+/* All nodes in one vector. Appending nodes copies them. */
+struct Contiguous_node_storage {
+  static constexpr bool share_identical_subtrees = false;
+  
+  template< class Node >
+  class Container {
+   public:
+    using const_iterator = typename std::vector< Node >::const_iterator;
+    
+    int size() const {
+      return nodes_.size();
+    }
+    
+    const Node& operator[](int i) const {
+      return nodes_[i];
+    }
+    
+    const_iterator begin() const {
+      return nodes_.begin();
+    }
+    
+    const_iterator end() const {
+      return nodes_.end();
+    }
+    
+    Node& modify(int i) {
+      return nodes_[i];
+    }
+    
+    void push_back(const Node& node) {
+      nodes_.push_back(node);
+    }
+    
+    void append(const Container& other, int first, int last) {
+      nodes_.insert(nodes_.end(), other.nodes_.begin() + first, other.nodes_.begin() + last);
+    }
+    
+    void repeat(int first, int last) {
+      nodes_.reserve(nodes_.size() + last - first);
+      for (int i = first; i != last; ++i) {
+        nodes_.push_back(nodes_[i]);
+      }
+    }
+    
+    void clear() {
+      nodes_.clear();
+    }
+    
+    void swap(Container& other) {
+      nodes_.swap(other.nodes_);
+    }
+   
+   private:
+    std::vector< Node > nodes_;
+  };
+};
+
+/* Nodes are shared between containers, one subtree at a time. The container
+ * is a sequence of segments, each of which is a range of consecutive nodes
+ * in a block. Appending nodes of another container only adds references to
+ * the other container's segments, and keeps their blocks alive, so a
+ * first-layer node over an old subtree costs one node and one segment, not
+ * a copy of the subtree. Positions stay virtual: node i is found by a search
+ * among the segments of its page of 32 positions, and arc endpoints are
+ * resolved in the same way as with Contiguous_node_storage.
+ * 
+ * Nodes of a shared block are immutable. The first time a node is modified,
+ * its whole segment is copied into a block of our own (copy on write), so
+ * that segments are never split. Once our own block is shared, it is frozen
+ * and we start a new one.
+ * 
+ * This saves memory when the same subtree is appended several times, as for
+ * generator bundles with several types over the same old root, at the cost
+ * of a search at every access. Pruning builds a new container, which
+ * releases the blocks of older containers.
+ */
+struct Shared_node_storage {
+  static constexpr bool share_identical_subtrees = false;
+  
+  template< class Node >
+  class Container {
+   public:
+    class const_iterator : public boost::iterator_facade<
+      const_iterator,
+      const Node,
+      boost::forward_traversal_tag
+    > {
+     public:
+      const_iterator() : container_(nullptr), i_(0) { }
+      
+      const_iterator(const Container* container, int i) :
+        container_(container),
+        i_(i)
+      { }
+     
+     private:
+      friend class boost::iterator_core_access;
+      
+      const Node& dereference() const {
+        return (*container_)[i_];
+      }
+      
+      bool equal(const const_iterator& other) const {
+        return i_ == other.i_;
+      }
+      
+      void increment() {
+        ++i_;
+      }
+      
+      const Container* container_;
+      int i_;
+    };
+    
+    Container() :
+      size_(0),
+      n_frozen_(0),
+      block_(std::make_shared< std::vector< Node > >())
+    { }
+    
+    int size() const {
+      return size_;
+    }
+    
+    const Node& operator[](int i) const {
+      const Segment_& segment = segments_[find_segment_(i)];
+      return (*segment.block)[segment.first + i - segment.position];
+    }
+    
+    const_iterator begin() const {
+      return const_iterator(this, 0);
+    }
+    
+    const_iterator end() const {
+      return const_iterator(this, size_);
+    }
+    
+    Node& modify(int i) {
+      if (block_.use_count() != 1) {
+        freeze_();
+      }
+      const int k = find_segment_(i);
+      Segment_& segment = segments_[k];
+      if (segment.block != block_.get() or segment.first < n_frozen_) {
+        // Copy on write, for the whole segment
+        const int n = segment_end_(k) - segment.position;
+        const int first = block_->size();
+        if (block_->capacity() < first + n) {  // segment.block may be block_
+          block_->reserve(std::max< std::size_t >(first + n, 2 * block_->capacity()));
+        }
+        for (int j = 0; j != n; ++j) {
+          block_->push_back((*segment.block)[segment.first + j]);
+        }
+        segment.first = first;
+        segment.block = block_.get();
+      }
+      return (*block_)[segment.first + i - segment.position];
+    }
+    
+    void push_back(const Node& node) {
+      const int block_first = block_->size();
+      if (
+        segments_.empty()
+        or segments_.back().block != block_.get()
+        or segments_.back().first + size_ - segments_.back().position != block_first
+      ) {
+        segments_.push_back({size_, block_first, block_.get()});
+      }
+      block_->push_back(node);
+      ++size_;
+      index_pages_();
+    }
+    
+    void append(const Container& other, int first, int last) {
+      if (first == last) {
+        return;
+      }
+      share_(other.block_);
+      for (const auto& block : other.shared_blocks_) {
+        share_(block);
+      }
+      add_segments_(other, first, last);
+      index_pages_();
+    }
+    
+    /* Repeated nodes are shared with their originals, so neither is ours to
+     * modify in place anymore.
+     */
+    void repeat(int first, int last) {
+      n_frozen_ = block_->size();
+      add_segments_(*this, first, last);
+      index_pages_();
+    }
+    
+    void clear() {
+      size_ = 0;
+      n_frozen_ = 0;
+      segments_.clear();
+      pages_.clear();
+      shared_blocks_.clear();
+      block_ = std::make_shared< std::vector< Node > >();
+    }
+    
+    void swap(Container& other) {
+      std::swap(size_, other.size_);
+      std::swap(n_frozen_, other.n_frozen_);
+      segments_.swap(other.segments_);
+      pages_.swap(other.pages_);
+      block_.swap(other.block_);
+      shared_blocks_.swap(other.shared_blocks_);
+    }
+   
+   private:
+    using Block_pointer_ = std::shared_ptr< std::vector< Node > >;
+    
+    /* Nodes from position to the position of the next segment are the nodes
+     * of block from first on.
+     */
+    struct Segment_ {
+      int position;
+      int first;
+      const std::vector< Node >* block;
+    };
+    
+    /* Positions are grouped in pages of page_size_ nodes, and pages_[p] is
+     * the index of the segment of the first node of page p. Segments are only
+     * added at the end, so pages are only added at the end too.
+     */
+    static constexpr int page_size_ = 32;
+    
+    /* Index of the segment of node i, searched in its page. */
+    int find_segment_(int i) const {
+      const int page = i / page_size_;
+      const auto first = segments_.begin() + pages_[page];
+      const auto last = (page + 1 == pages_.size()
+                         ? segments_.end()
+                         : segments_.begin() + pages_[page + 1] + 1);
+      return std::upper_bound(
+        first,
+        last,
+        i,
+        [](int position, const Segment_& segment) { return position < segment.position; }
+      ) - segments_.begin() - 1;
+    }
+    
+    void index_pages_() {
+      int k = pages_.empty() ? 0 : pages_.back();
+      for (int position = pages_.size() * page_size_; position < size_; position += page_size_) {
+        while (segment_end_(k) <= position) {
+          ++k;
+        }
+        pages_.push_back(k);
+      }
+    }
+    
+    int segment_end_(int k) const {
+      return k + 1 == segments_.size() ? size_ : segments_[k + 1].position;
+    }
+    
+    /* Add references to the nodes of a container from first to last - 1,
+     * extending the last segment when they follow it in the same block. The
+     * container may be this one.
+     */
+    void add_segments_(const Container& other, int first, int last) {
+      const int n_segments = other.segments_.size();
+      for (
+        int k = other.find_segment_(first);
+        k != n_segments and other.segments_[k].position < last;
+        ++k
+      ) {
+        const Segment_ segment = other.segments_[k];
+        const int begin = std::max(first, segment.position);
+        const int end = std::min(last, other.segment_end_(k));
+        const int block_first = segment.first + begin - segment.position;
+        if (
+          segments_.empty()
+          or segments_.back().block != segment.block
+          or segments_.back().first + size_ - segments_.back().position != block_first
+        ) {
+          segments_.push_back({size_, block_first, segment.block});
+        }
+        size_ += end - begin;
+      }
+    }
+    
+    void share_(const Block_pointer_& block) {
+      if (
+        block != block_
+        and std::find(shared_blocks_.begin(), shared_blocks_.end(), block) == shared_blocks_.end()
+      ) {
+        shared_blocks_.push_back(block);
+      }
+    }
+    
+    /* Someone else points to our block: keep it as a shared block. */
+    void freeze_() {
+      shared_blocks_.push_back(block_);
+      block_ = std::make_shared< std::vector< Node > >();
+      n_frozen_ = 0;
+    }
+    
+    int size_;
+    int n_frozen_;  // nodes of block_ before n_frozen_ are repeated
+    std::vector< Segment_ > segments_;  // sorted by position
+    std::vector< int > pages_;
+    Block_pointer_ block_;
+    std::vector< Block_pointer_ > shared_blocks_;
+  };
+};
+
+/* Same as Shared_node_storage, but reduced forests are hash-consed: a
+ * subtree whose descendants are identical to those of an earlier subtree
+ * points to the nodes of the earlier one. This saves memory when different
+ * generator bundles reduce to the same subtrees, both in the reduced forest
+ * and in the next forests, which append these nodes again.
+ */
+struct Hash_consed_node_storage : Shared_node_storage {
+  static constexpr bool share_identical_subtrees = true;
+};
+
+#endif  // NODE_STORAGE_H_
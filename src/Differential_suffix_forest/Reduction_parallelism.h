@@ -0,0 +1,61 @@
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *\
+ *                                                                           *
+ *  Bundled HFK - a knot Floer homology calculator                           *
+ *                                                                           *
+ *  Copyright (C) 2021-2022  Isaac Ren                                       *
+ *  For further details, contact Isaac Ren (gopi3.1415@gmail.com).           *
+ *                                                                           *
+ *  This program is free software: you can redistribute it and/or modify     *
+ *  it under the terms of the GNU General Public License as published by     *
+ *  the Free Software Foundation, either version 3 of the License, or        *
+ *  (at your option) any later version.                                      *
+ *                                                                           *
+ *  This program is distributed in the hope that it will be useful,          *
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of           *
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the            *
+ *  GNU General Public License for more details.                             *
+ *                                                                           *
+ *  You should have received a copy of the GNU General Public License        *
+ *  along with this program.  If not, see <https://www.gnu.org/licenses/>.   *
+ *                                                                           *
+\* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+
+#ifndef REDUCTION_PARALLELISM_H_
+#define REDUCTION_PARALLELISM_H_
+
+#include "Utility/Parallel_for.h"
+
+/* Reduction parallelism policies.
+ * 
+ * A reduction parallelism policy tells Differential_suffix_forest how many
+ * threads to use for locking coefficients and for computing the zig-zag arcs
+ * of a contraction.
+ * 
+ * Contractions stay serial: arcs are contracted one at a time, in the
+ * contraction order. Within one contraction, the compatible pairs of back and
+ * front arcs are split into consecutive blocks, the products of each block
+ * are computed on their own thread, and the blocks are concatenated in order.
+ * Hence the zig-zag arcs and their order are the same as with
+ * Serial_reduction, whatever the number of threads.
+ * 
+ * Threads are only started for enough products: at least
+ * min_products_per_thread for each thread.
+ */
+struct Serial_reduction {
+  static constexpr int min_products_per_thread = 1;
+  
+  static int n_threads() {
+    return 1;
+  }
+};
+
+template< int Min_products_per_thread = 256 >
+struct Parallel_reduction {
+  static constexpr int min_products_per_thread = Min_products_per_thread;
+  
+  static int n_threads() {
+    return default_n_threads();
+  }
+};
+
+#endif  // REDUCTION_PARALLELISM_H_
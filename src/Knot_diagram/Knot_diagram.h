@@ -127,6 +127,15 @@ class Knot_diagram {
   
   template< class Polynomial, class D_module >
   Polynomial knot_Floer_homology() const {
+    Ignored_statistics_ statistics;
+    return knot_Floer_homology< Polynomial, D_module >(statistics);
+  }
+  
+  /* Same, and add up the statistics returned by the reduction of each layer
+   * (see Differential_suffix_forest::Reduction_statistics).
+   */
+  template< class Polynomial, class D_module, class Statistics >
+  Polynomial knot_Floer_homology(Statistics& statistics) const {
 #ifdef BUNDLED_HFK_VERBOSE_
     std::cout << "[kd] Computing knot Floer homology..." << std::endl;
 #endif  // BUNDLED_HFK_VERBOSE_
@@ -136,15 +145,20 @@ class Knot_diagram {
     
     const auto da_bimodules = Detail_< D_module >::get_da_bimodules(morse_data_);
     
-    D_module d_module;
-    d_module.set_as_trivial();
+    // The two D-modules take turns as the old and the new one
+    D_module d_modules[2];
+    int current = 0;
+    d_modules[current].set_as_trivial();
     
     // box tensor product for each Morse event
     for (int i = 0; i != da_bimodules.size(); ++i) {
+      D_module& old_d_module = d_modules[current];
+      current = 1 - current;
+      D_module& d_module = d_modules[current];
 #ifdef BUNDLED_HFK_VERBOSE_
       std::cout << "[kd] layer " << i << ": " << da_bimodules[i] << "... " << std::flush;
 #endif  // BUNDLED_HFK_VERBOSE_
-      d_module = box_tensor_product(da_bimodules[i], d_module);
+      box_tensor_product(da_bimodules[i], old_d_module, d_module);
 #ifdef BUNDLED_HFK_DRAW_
       suffix_forest << "Before reduction:\n";
       d_module.TeXify(suffix_forest);
@@ -153,7 +167,7 @@ class Knot_diagram {
 #ifdef BUNDLED_HFK_VERBOSE_
       std::cout << "reducing... " << std::flush;
 #endif  // BUNDLED_HFK_VERBOSE_
-      d_module.reduce();
+      statistics += d_module.reduce();
 #ifdef BUNDLED_HFK_DRAW_
       suffix_forest << "After reduction:\n";
       d_module.TeXify(suffix_forest);
@@ -168,10 +182,17 @@ class Knot_diagram {
     suffix_forest.close();
 #endif  // BUNDLED_HFK_DRAW_
     
-    return d_module.template poincare_polynomial< Polynomial >();
+    return d_modules[current].template poincare_polynomial< Polynomial >();
   }
   
  private:
+  struct Ignored_statistics_ {
+    template< class Statistics >
+    Ignored_statistics_& operator+=(const Statistics&) {
+      return *this;
+    }
+  };
+  
   /* All the private methods depend on a choice of D-module. In order to
    * make things hopefully more readable, I've put all these methods as static
    * methods in a private struct Detail_, templated by D_module.
@@ -58,6 +58,20 @@ class DA_bimodule {
     const D_module& old_d_module
   ) {
     D_module new_d_module;
+    box_tensor_product(da_bimodule, old_d_module, new_d_module);
+    return new_d_module;
+  }
+  
+  /* Same, but into an existing D-module, which is cleared first. This lets
+   * two D-modules take turns as the old and the new one, keeping their
+   * allocated storage from one layer to the next.
+   */
+  friend void box_tensor_product(
+    const DA_bimodule& da_bimodule,
+    const D_module& old_d_module,
+    D_module& new_d_module
+  ) {
+    new_d_module.clear();
     da_bimodule.morse_event.tensor_generators(
       new_d_module,
       old_d_module,
@@ -80,7 +94,6 @@ class DA_bimodule {
       da_bimodule.lower_algebra
     );
     new_d_module.lock_coefficients();
-    return new_d_module;
   }
   
 #ifdef BUNDLED_HFK_VERBOSE_
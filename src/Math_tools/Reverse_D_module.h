@@ -23,6 +23,8 @@
 #ifndef D_MODULE_REVERSE_VIEW_
 #define D_MODULE_REVERSE_VIEW_
 
+#include <utility>  // declval
+
 /* Reverse view of a D-module.
  * 
  * Reverses the directions of all arcs.
@@ -47,6 +49,7 @@ class Reverse_D_module {
   using Coef_bundle = typename D_module::Coef_bundle;
   using Coef_bundle_container = typename D_module::Coef_bundle_container;
   using Coef_bundle_reference = typename D_module::Coef_bundle_reference;
+  using Coef_bundle_range = typename D_module::Coef_bundle_range;
   
   Reverse_D_module(D_module& d_module) :
     d_module_(d_module)
@@ -76,7 +79,7 @@ class Reverse_D_module {
     return d_module_.source_idem(coef);
   }
   
-  std::vector< int > U_weights(const Coef_bundle& coef) const {
+  const typename Bordered_algebra::U_weights_type& U_weights(const Coef_bundle& coef) const {
     return d_module_.U_weights(coef);
   }
   
@@ -159,26 +162,22 @@ class Reverse_D_module {
     d_module_.lock_coefficients();
   }
   
-  /* Views on coefs */
+  /* Views on coefs, forwarded without copying */
   
-  const std::vector< Coef_bundle_reference >
-  others_to_source(const Coef_bundle& coef) const {
+  Coef_bundle_range others_to_source(const Coef_bundle& coef) const {
     return d_module_.others_from_target(coef);
   }
   
-  const std::vector< Coef_bundle_reference >
-  others_from_target(const Coef_bundle& coef) const {
+  Coef_bundle_range others_from_target(const Coef_bundle& coef) const {
     return d_module_.others_to_source(coef);
   }
   
-  const std::vector< Coef_bundle_reference >
-  others_from_source(const Coef_bundle& coef) const {
-    return others_to_target(coef);
+  Coef_bundle_range others_from_source(const Coef_bundle& coef) const {
+    return d_module_.others_to_target(coef);
   }
   
-  const std::vector< Coef_bundle_reference >
-  others_to_target(const Coef_bundle& coef) const {
-    return others_from_source(coef);
+  Coef_bundle_range others_to_target(const Coef_bundle& coef) const {
+    return d_module_.others_from_source(coef);
   }
   
   /* Operations on coefs */
@@ -197,13 +196,16 @@ class Reverse_D_module {
     return d_module_.concatenate(front_coef, back_coef);
   }
   
-  void reduce() {
-    d_module_.reduce();
+  decltype(std::declval< D_module& >().reduce()) reduce() {
+    return d_module_.reduce();
   }
   
   template< class Polynomial >
-  Polynomial poincare_polynomial(const Idem& idem = Idem("0")) const {
-    return d_module_.poincare_polynomial(idem);
+  Polynomial poincare_polynomial(
+    const Idem& idem = Idem("0"),
+    std::vector< Weights >* leaf_gradings = nullptr
+  ) const {
+    return d_module_.template poincare_polynomial< Polynomial >(idem, leaf_gradings);
   }
   
   /* I/O interface */
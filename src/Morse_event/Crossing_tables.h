@@ -0,0 +1,288 @@
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *\
+ *                                                                           *
+ *  Bundled HFK - a knot Floer homology calculator                           *
+ *                                                                           *
+ *  Copyright (C) 2021-2022  Isaac Ren                                       *
+ *  For further details, contact Isaac Ren (gopi3.1415@gmail.com).           *
+ *                                                                           *
+ *  This program is free software: you can redistribute it and/or modify     *
+ *  it under the terms of the GNU General Public License as published by     *
+ *  the Free Software Foundation, either version 3 of the License, or        *
+ *  (at your option) any later version.                                      *
+ *                                                                           *
+ *  This program is distributed in the hope that it will be useful,          *
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of           *
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the            *
+ *  GNU General Public License for more details.                             *
+ *                                                                           *
+ *  You should have received a copy of the GNU General Public License        *
+ *  along with this program.  If not, see <https://www.gnu.org/licenses/>.   *
+ *                                                                           *
+\* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+
+#ifndef CROSSING_TABLES_H_
+#define CROSSING_TABLES_H_
+
+#include <cstdint>  // uint64_t
+
+/* Decision tables for crossings.
+ * 
+ * Positive crossings (and negative crossings, through a reverse view) decide
+ * markings by looking up the local weights of coefficients. These tables are
+ * computed at compile time, and do not depend on the D-module, so all
+ * instantiations of Positive_crossing share them.
+ * 
+ * Entries take 2 bits and are packed in 64-bit words.
+ * - look_back is the \delta_2 look-back table (D2PHSEM_), indexed by hash
+ *   index;
+ * - delta_3_decision tells whether \delta_3 makes a coefficient from a back
+ *   coefficient, a front coefficient and a front marking.
+ */
+template< class = void >
+struct Crossing_tables {
+  enum {
+    N = 0,
+    E,  // 1
+    S,  // 2
+    W,  // 3
+    null_NEW = 2,
+    null_S = 0,
+    null = 0
+  };
+  
+  /* Outcomes of delta_3_decision. Some coefficients with a null product
+   * marking are only made if some U weights are zero, which the table does
+   * not know.
+   */
+  enum {
+    no_coef = 0,
+    coef,  // 1
+    coef_if_E_weights_zero,  // 2: u1 = u2 = v1 = 0
+    coef_if_W_weights_zero  // 3: u1 = u2 = v2 = 0
+  };
+  
+  /* Make a hash index for the data (local LR weight, local U weight, marking).
+   * 
+   * Each index is unique, except when (a1, a2) = (1, -1) or (-1, 1), in which
+   * case they share an index. These local LR weights do not happen.
+   * 
+   * a1 a2 i_local_LR
+   *  0  0     4
+   *  0  1     1
+   *  0 -1     7
+   *  1  0     5
+   *  1  1     2
+   *  1 -1     0
+   * -1  0     3
+   * -1  1     0
+   * -1 -1     6
+   * 
+   * The result is an integer between 0 and 127.
+   */
+  static constexpr int hash_index(int a1, int a2, int u1, int u2, int marking) {
+    return pre_hash_index(a1, a2, u1, u2) + marking;
+  }
+  
+  static constexpr int pre_hash_index(int a1, int a2, int u1, int u2) {
+    return (local_LR_index_(a1, a2) << 4) + (U_diff_index(u1, u2) << 2);
+  }
+  
+  /* Sign of u1 - u2, with 3 = negative */
+  static constexpr int U_diff_index(int u1, int u2) {
+    return u1 > u2 ? 1 : (u1 < u2 ? 3 : 0);
+  }
+  
+  static int look_back(int hash_index) {
+    return Look_back_::at(hash_index);
+  }
+  
+  /* Pre-hash indices are multiples of 4, and product_U_diff is the U
+   * difference index of the product of the back and front coefficients.
+   */
+  static int delta_3_decision(
+    int back_pre_hash_index,
+    int front_pre_hash_index,
+    int front_marking,
+    int product_U_diff
+  ) {
+    return Delta_3_::at(
+      (back_pre_hash_index << 7) + (front_pre_hash_index << 2)
+      + (front_marking << 2) + product_U_diff
+    );
+  }
+ 
+ private:
+  static constexpr int local_LR_index_(int a1, int a2) {
+    return (4 + a1 - 3 * a2) & 7;
+  }
+  
+  /* Local LR weights of an index of local_LR_index_. For index 0, this is the
+   * last pair written by the original table, (1, -1).
+   */
+  static constexpr int a1_(int i_local_LR) {
+    return (i_local_LR == 3 or i_local_LR == 6) ? -1
+           : ((i_local_LR == 0 or i_local_LR == 2 or i_local_LR == 5) ? 1 : 0);
+  }
+  
+  static constexpr int a2_(int i_local_LR) {
+    return (i_local_LR == 0 or i_local_LR == 6 or i_local_LR == 7) ? -1
+           : ((i_local_LR == 1 or i_local_LR == 2) ? 1 : 0);
+  }
+  
+  /* \delta_2 positive horizontal source edge marking.
+   * 
+   * Adapted from ComputeHFKv2/Crossing.cpp, LookBack.
+   * 
+   * Given the marking of a horizontal target edge with local LR weight and U
+   * weight, return the marking of the horizontal source edge.
+   */
+  static constexpr int D2PHSEM_(int a1, int a2, int u1, int u2, int marking) {
+    return
+      marking == N ? (
+        (             a1 == a2             ) ? N  // 1, L_1L_2, R_2R_1
+      : (a1 ==  1 and a2 ==  0 and u1 <  u2) ? E  // R_1U_2
+      : (a1 ==  1 and a2 ==  0 and u1 >= u2) ? W  // R_1
+      : (a1 ==  0 and a2 == -1 and u1 <= u2) ? E  // L_2
+      : (a1 ==  0 and a2 == -1 and u1 >  u2) ? W  // L_2U_1
+      : null_NEW)
+      : marking == E ? (
+        (a1 ==  0 and a2 ==  0 and u1 <= u2) ? E  // 1
+      : (a1 ==  0 and a2 ==  0 and u1 >  u2) ? W  // U1
+      : (a1 == -1 and a2 ==  0             ) ? N  // L_1
+      : (a1 ==  0 and a2 ==  1             ) ? N  // R_2
+      : null_NEW)
+      : marking == W ? (
+        (a1 ==  0 and a2 ==  0 and u1 <  u2) ? E  // U2
+      : (a1 ==  0 and a2 ==  0 and u1 >= u2) ? W  // 1
+      : (a1 == -1 and a2 ==  0             ) ? N  // L_1
+      : (a1 ==  0 and a2 ==  1             ) ? N  // R_2
+      : null_NEW)
+      : marking == S ? (
+        (             u1 == u2             ) ? S  // 1
+      : null_S)
+      : null;  // this should never happen
+  }
+  
+  /* Entry of the look-back table. The U weights of the index stand for
+   * (u1, 0) with u1 in {-1, 0, 1}, and U difference index 2 is unused.
+   */
+  struct Look_back_entries_ {
+    static constexpr int size = 128;
+    
+    static constexpr int entry(int hash_index) {
+      return ((hash_index >> 2) & 3) == 2 ? null : D2PHSEM_(
+        a1_(hash_index >> 4),
+        a2_(hash_index >> 4),
+        ((hash_index >> 2) & 3) == 1 ? 1 : (((hash_index >> 2) & 3) == 3 ? -1 : 0),
+        0,
+        hash_index & 3
+      );
+    }
+  };
+  
+  /* We follow [OzsvathSzabo2018, Lemma 5.5]. Given a front marking Y, we
+   * compute the mid marking I(b, Y), the back marking I(a, I(b, Y)), and the
+   * product marking I(ab, Y). Indices are made of the pre-hash indices of the
+   * back and front coefficients divided by 4 (5 bits each), the front marking
+   * and the U difference index of the product.
+   */
+  struct Delta_3_entries_ {
+    static constexpr int size = 1 << 14;
+    
+    static constexpr int entry(int index) {
+      return ((index >> 2) & 3) == S ? no_coef : entry_with_mid_(
+        index >> 9,
+        (index >> 4) & 31,
+        (index >> 2) & 3,
+        index & 3,
+        look_back_entry_(((index >> 4) & 31) * 4 + ((index >> 2) & 3))
+      );
+    }
+    
+    static constexpr int look_back_entry_(int hash_index) {
+      return Look_back_entries_::entry(hash_index);
+    }
+    
+    // check that mid isn't null
+    static constexpr int entry_with_mid_(
+      int back, int front, int front_marking, int product_U_diff, int mid_marking
+    ) {
+      return mid_marking == null_NEW ? no_coef : entry_with_markings_(
+        a1_(back >> 2), a2_(back >> 2), a1_(front >> 2), a2_(front >> 2),
+        front_marking,
+        look_back_entry_(back * 4 + mid_marking),
+        look_back_entry_(
+          (local_LR_index_(a1_(back >> 2) + a1_(front >> 2), a2_(back >> 2) + a2_(front >> 2)) << 4)
+          + (product_U_diff << 2) + front_marking
+        )
+      );
+    }
+    
+    /* If product marking is null, we either have (R_1, R_2U_2^t) for E
+     * or (L_2, L_1U_1^n) for W. We exclude all other cases.
+     * TO DO: Understand why this is here.
+     */
+    static constexpr int entry_with_markings_(
+      int a1, int a2, int b1, int b2,
+      int front_marking, int back_marking, int product_marking
+    ) {
+      return
+        // check that back is not equal to product
+        back_marking == product_marking ? no_coef
+      : (product_marking == null_NEW and front_marking == E) ? (
+          (a1 == 1 and a2 == 0 and b1 == 0 and b2 == 1) ? coef_if_E_weights_zero : no_coef)
+      : (product_marking == null_NEW and front_marking == W) ? (
+          (a1 == 0 and a2 == -1 and b1 == -1 and b2 == 0) ? coef_if_W_weights_zero : no_coef)
+      : coef;
+    }
+  };
+  
+  /* One word of a packed table: 32 entries of 2 bits. */
+  template< class Entries >
+  struct Packed_word_ {
+    static constexpr std::uint64_t value(int word, int k = 0) {
+      return k == 32 ? 0 : (
+        (static_cast< std::uint64_t >(Entries::entry(32 * word + k)) << (2 * k))
+        | value(word, k + 1)
+      );
+    }
+  };
+  
+  /* Packed table of the entries of Entries, with one word for each index in
+   * Words.
+   */
+  template< class Entries, int... Words >
+  struct Packed_table_ {
+    static constexpr std::uint64_t words[sizeof...(Words)] = {
+      Packed_word_< Entries >::value(Words)...
+    };
+    
+    static int at(int index) {
+      return (words[index >> 5] >> (2 * (index & 31))) & 3;
+    }
+  };
+  
+  /* Packed_table_< Entries, 0, 1, ..., N_words - 1 > */
+  template< class Entries, int N_words, int... Words >
+  struct Make_packed_table_ :
+    Make_packed_table_< Entries, N_words - 1, N_words - 1, Words... > { };
+  
+  template< class Entries, int... Words >
+  struct Make_packed_table_< Entries, 0, Words... > {
+    using type = Packed_table_< Entries, Words... >;
+  };
+  
+  template< class Entries >
+  using Packed_table_of_ =
+    typename Make_packed_table_< Entries, Entries::size / 32 >::type;
+  
+  using Look_back_ = Packed_table_of_< Look_back_entries_ >;
+  using Delta_3_ = Packed_table_of_< Delta_3_entries_ >;
+};
+
+template< class T >
+template< class Entries, int... Words >
+constexpr std::uint64_t
+  Crossing_tables< T >::Packed_table_< Entries, Words... >::words[sizeof...(Words)];
+
+#endif  // CROSSING_TABLES_H_
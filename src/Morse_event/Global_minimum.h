@@ -81,7 +81,7 @@ class Global_minimum {
     return {"{}"};
   }
   
-  D_module tensor_generators(
+  void tensor_generators(
     D_module& new_d_module,
     const D_module& old_d_module,
     const Algebra&,
@@ -90,17 +90,14 @@ class Global_minimum {
     for (const auto& gen_handle : old_d_module.gen_bundle_handles()) {
       new_d_module.add_gen_bundle(Idem("0"), 0, gen_handle);
     }
-    return new_d_module;
   }
   
-  D_module& tensor_coefficients(
-    D_module& new_d_module,
+  void tensor_coefficients(
+    D_module&,
     const D_module&,
     const Algebra&,
     const Algebra&
-  ) const {
-    return new_d_module;
-  }
+  ) const { }
   
 #ifdef BUNDLED_HFK_VERBOSE_
   friend std::ostream& operator<<(
@@ -43,6 +43,7 @@ class Local_maximum {
   using Algebra = typename D_module::Bordered_algebra;
   using Coef_bundle = typename D_module::Coef_bundle;
   using Weights = typename D_module::Weights;  // currently, pair of int
+  using U_weights_type = typename Algebra::U_weights_type;
   
   Local_maximum(const std::vector< typename Morse_event_options::Parameter_type >& args) :
     position_(args.empty() ? 0 : Morse_event_options::template parameter_cast< int >(args[0]))
@@ -113,17 +114,16 @@ class Local_maximum {
     return labels;
   }
   
-  D_module tensor_generators(
+  void tensor_generators(
     D_module& new_d_module,
     const D_module& old_d_module,
     const Algebra&,
     const Algebra&
   ) const {
     delta_0_(new_d_module, old_d_module);
-    return new_d_module;
   }
   
-  D_module& tensor_coefficients(
+  void tensor_coefficients(
     D_module& new_d_module,
     const D_module& old_d_module,
     const Algebra&,
@@ -131,7 +131,6 @@ class Local_maximum {
   ) const {
     delta_1_(new_d_module, old_d_module);
     delta_2_(new_d_module, old_d_module);
-    return new_d_module;
   }
   
 #ifdef BUNDLED_HFK_VERBOSE_
@@ -189,7 +188,7 @@ class Local_maximum {
     for (const auto& coef : old_d_module.coef_bundles()) {
       const Idem& back_idem = old_d_module.source_idem(coef);
       const Idem& front_idem = old_d_module.target_idem(coef);
-      std::vector< int > new_U_weights = old_d_module.U_weights(coef);
+      U_weights_type new_U_weights = old_d_module.U_weights(coef);
       
       int a1, a2;
       std::tie(a1, a2) = get_local_weights_(back_idem, front_idem);
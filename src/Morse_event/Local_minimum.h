@@ -43,6 +43,7 @@ class Local_minimum {
   using Algebra = typename D_module::Bordered_algebra;
   using Coef_bundle = typename D_module::Coef_bundle;
   using Weights = typename D_module::Weights;
+  using U_weights_type = typename Algebra::U_weights_type;
   
   Local_minimum(const std::vector< typename Morse_event_options::Parameter_type >& args) :
     position_(args.empty() ? 0 : Morse_event_options::template parameter_cast< int >(args[0])) 
@@ -138,17 +139,16 @@ class Local_minimum {
     return labels;
   }
   
-  D_module tensor_generators(
+  void tensor_generators(
     D_module& new_d_module,
     const D_module& old_d_module,
     const Algebra&,
     const Algebra&
   ) const {
     delta_0_(new_d_module, old_d_module);
-    return new_d_module;
   }
   
-  D_module& tensor_coefficients(
+  void tensor_coefficients(
     D_module& new_d_module,
     const D_module& old_d_module,
     const Algebra& upper_algebra,
@@ -156,7 +156,6 @@ class Local_minimum {
   ) const {
     delta_2_(new_d_module, old_d_module, upper_algebra, lower_algebra);
     delta_geq_4_(new_d_module, old_d_module, upper_algebra, lower_algebra);
-    return new_d_module;
   }
     
 #ifdef BUNDLED_HFK_VERBOSE_
@@ -206,7 +205,7 @@ class Local_minimum {
         and extendable_(old_d_module.target_idem(coef), YR2)
       ) {
         /* Add curved weight*/
-        std::vector< int > new_U_weights = old_d_module.U_weights(coef);
+        U_weights_type new_U_weights = old_d_module.U_weights(coef);
         new_U_weights[upper_algebra.matchings[0]] += new_U_weights[1];
         
         shorten_and_finish_(old_d_module, new_d_module, new_U_weights, coef);
@@ -247,75 +246,35 @@ class Local_minimum {
       }
     }
     
-    /* Initialize building blocks of sequences */
+    /* Sequences are L_1 U_0 (U_1 U_0)^k R_1, modulo 2. We extend the
+     * partial sequences L_1 U_0 (U_1 U_0)^k one step at a time, and close
+     * them with R_1. The groups U_1 U_0 and R_1 are joined with every
+     * partial sequence, so they are sorted once.
+     */
     std::vector< Coef_bundle > sequences_back =
-      concatenate_groups_(old_d_module, L_1, U_0);
-    const std::vector< Coef_bundle > sequences_mid =
-      concatenate_groups_(old_d_module, U_1, U_0);
-    std::vector< Coef_bundle > sequences =
-      concatenate_groups_(old_d_module, sequences_back, R_1);
+      old_d_module.concatenate_groups(L_1, U_0);
+    const auto sequences_mid = old_d_module.front_group(
+      old_d_module.concatenate_groups(U_1, U_0)
+    );
+    const auto sequences_front = old_d_module.front_group(R_1);
     
-    /* This loop ends for mathematical reasons. If the input is not a knot,
-     * there is no guarantee that this ends.
+    /* This loop ends for mathematical reasons: partial sequences become
+     * longer and eventually cancel. If the input is not a knot, there is no
+     * guarantee that this ends.
      */
-    for (int n_coefs = 1; !sequences.empty(); ++n_coefs) {
-      for (const auto& coef : sequences) {
-        std::vector< int > new_U_weights = old_d_module.U_weights(coef);
+    for (int n_coefs = 1; !sequences_back.empty(); ++n_coefs) {
+      for (
+        const auto& coef
+        : old_d_module.concatenate_groups(sequences_back, sequences_front)
+      ) {
+        U_weights_type new_U_weights = old_d_module.U_weights(coef);
         new_U_weights[upper_algebra.matchings[0]] += new_U_weights[1] - n_coefs;
         new_U_weights[upper_algebra.matchings[1]] += new_U_weights[0] - n_coefs;
         shorten_and_finish_(old_d_module, new_d_module, new_U_weights, coef);
       }
       sequences_back =
-        concatenate_groups_(old_d_module, sequences_back, sequences_mid);
-      sequences = concatenate_groups_(old_d_module, sequences_back, R_1);
-      // debug, I think
-      if (n_coefs >= 10) { std::cout << "[lm] Giving up!" << std::endl; return; }
-    }
-  }
-  
-  /* Concatenate two groups of coefficients.
-   * TO DO: sort both sets by... suffix of target (resp. source)? I don't think
-   * this works with agglomerated coefs, though
-   */
-  std::vector< Coef_bundle > concatenate_groups_(
-    const D_module& old_d_module,
-    const std::vector< Coef_bundle >& back_group,
-    const std::vector< Coef_bundle >& front_group
-  ) const {
-    std::vector< Coef_bundle > result;
-    for (const Coef_bundle& back_coef : back_group) {
-      for (const Coef_bundle& front_coef : front_group) {
-        if (
-          old_d_module.source_idem(back_coef).too_far_from(
-            old_d_module.target_idem(front_coef)
-          )
-        ) {
-          continue;
-        }
-        if (!old_d_module.compatible(back_coef, front_coef)) { continue; }
-        Coef_bundle concat_coef =
-          old_d_module.concatenate(back_coef, front_coef);
-        result.push_back(concat_coef);
-      }
-    }
-    /* modulo 2 */
-    std::vector< bool > canceled(result.size(), false);
-    for (int i = 0; i < result.size(); ++i) {
-      for (int j = i + 1; j < result.size(); ++j) {
-        if (!canceled[j] and result[i] == result[j]) {
-          canceled[i] = true;
-          canceled[j] = true;
-          break;
-        }
-      }
-    }
-    std::vector< Coef_bundle > new_result;
-    for (int i = 0; i < result.size(); ++i) {
-      if (!canceled[i]) {
-        new_result.push_back(result[i]);
-      }
+        old_d_module.concatenate_groups(sequences_back, sequences_mid);
     }
-    return new_result;
   }
   
   /* For \delta_{\geq 2}.
@@ -325,7 +284,7 @@ class Local_minimum {
   void shorten_and_finish_(
     const D_module& old_d_module,
     D_module& new_d_module,
-    std::vector< int >& new_U_weights,
+    U_weights_type& new_U_weights,
     const Coef_bundle& old_coef
   ) const {
     /* Shorten idempotents and U weight vector */
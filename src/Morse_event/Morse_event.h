@@ -100,7 +100,7 @@ struct Algebraic_methods :
       const boost::type_erasure::_self
     >,
     has_tensor_generators<
-      D_module(
+      void(
         D_module&,
         const D_module&,
         const typename D_module::Bordered_algebra&,
@@ -109,7 +109,7 @@ struct Algebraic_methods :
       const boost::type_erasure::_self
     >,
     has_tensor_coefficients<
-      D_module(
+      void(
         D_module&,
         const D_module&,
         const typename D_module::Bordered_algebra&,
@@ -116,7 +116,7 @@ class Negative_crossing {
     );
   }
   
-  D_module tensor_generators(
+  void tensor_generators(
     D_module& new_d_module,
     const D_module& old_d_module,
     const Algebra& upper_algebra,
@@ -130,10 +130,9 @@ class Negative_crossing {
       upper_algebra,
       lower_algebra
     );
-    return new_d_module;
   }
   
-  D_module& tensor_coefficients(
+  void tensor_coefficients(
     D_module& new_d_module,
     const D_module& old_d_module,
     const Algebra& upper_algebra,
@@ -147,7 +146,6 @@ class Negative_crossing {
       upper_algebra,
       lower_algebra
     );
-    return new_d_module;
   }
   
 #ifdef BUNDLED_HFK_VERBOSE_
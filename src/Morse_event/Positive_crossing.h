@@ -25,7 +25,6 @@
 
 #include <cstdlib>  // abs
 #include <string>
-#include <tuple>
 #include <utility>  // pair, swap
 #include <vector>
 
@@ -33,10 +32,7 @@
 #include <iostream>
 #endif  // BUNDLED_HFK_VERBOSE_
 
-#include <boost/mpl/vector_c.hpp>
-#include <boost/mpl/for_each.hpp>
-
-#include "Utility/Two_bit_set.h"
+#include "Crossing_tables.h"
 
 /* DA bimodule for a crossing.
  * 
@@ -50,8 +46,9 @@ class Positive_crossing {
   using Algebra = typename D_module::Bordered_algebra;
   using Coef_bundle = typename D_module::Coef_bundle;
   using Weights = typename D_module::Weights;
+  using U_weights_type = typename Algebra::U_weights_type;
   
-  using Table = Two_bit_set< 128 >;
+  using Tables = Crossing_tables<>;
   
   Positive_crossing(const std::vector< typename Morse_event_options::Parameter_type >& args) :
     position_(args.empty() ? 0 : Morse_event_options::template parameter_cast< int >(args[0]))
@@ -124,17 +121,16 @@ class Positive_crossing {
     return labels;
   }
   
-  D_module tensor_generators(
+  void tensor_generators(
     D_module& new_d_module,
     const D_module& old_d_module,
     const Algebra&,
     const Algebra&
   ) const {
     delta_0_(new_d_module, old_d_module);
-    return new_d_module;
   }
   
-  D_module& tensor_coefficients(
+  void tensor_coefficients(
     D_module& new_d_module,
     const D_module& old_d_module,
     const Algebra& upper_algebra,
@@ -143,7 +139,6 @@ class Positive_crossing {
     delta_1_(new_d_module, old_d_module, upper_algebra, lower_algebra);
     delta_2_(new_d_module, old_d_module);
     delta_3_(new_d_module, old_d_module);
-    return new_d_module;
   }
   
 #ifdef BUNDLED_HFK_VERBOSE_
@@ -272,7 +267,7 @@ class Positive_crossing {
           new_d_module.add_coef_bundle(alg_el, we_marking, S, old_idem);
           
           if (upper_algebra.matchings[position_] != position_ + 1) {  // curved
-            std::vector< int > U_curved(upper_algebra.n_strands, 0);
+            U_weights_type U_curved(upper_algebra.n_strands, 0);
             U_curved[lower_algebra.matchings[position_ + we]] = 1;
             auto alg_el = new_d_module.alg_el(old_idem, we_idem, U_curved);
             new_d_module.add_coef_bundle(alg_el, S, we_marking, old_idem);
@@ -287,16 +282,14 @@ class Positive_crossing {
   void delta_2_(D_module& new_d_module, const D_module& old_d_module) const {
     for (const auto& coef : old_d_module.coef_bundles()) {
       /* Calculate preliminary information */
-      int a1, a2, u1, u2;
-      std::tie(a1, a2, u1, u2) = get_local_weights_(coef, old_d_module);
-      int pre_hash_index = pre_hash_index_(a1, a2, u1, u2);
+      const Local_weights_ local_weights = get_local_weights_(coef, old_d_module);
       
       for (const Gen_type front_marking : {N, W, S, E}) {
         if (!extendable_(old_d_module.target_idem(coef), front_marking)) {
           continue;
         }
         const Gen_type back_marking =
-          positive_look_back_[pre_hash_index + front_marking];
+          Tables::look_back(local_weights.pre_hash_index + front_marking);
         if (!extendable_(old_d_module.source_idem(coef), back_marking)) {
           continue;
         }
@@ -310,9 +303,9 @@ class Positive_crossing {
         }
         
         /* Calculate new algebra element */
-        std::vector<int> U_weights = old_d_module.U_weights(coef);
-        int v1 = 2 * u1 + std::abs(a1);
-        int v2 = 2 * u2 + std::abs(a2);
+        U_weights_type U_weights = old_d_module.U_weights(coef);
+        int v1 = 2 * local_weights.u1 + std::abs(local_weights.a1);
+        int v2 = 2 * local_weights.u2 + std::abs(local_weights.a2);
         if (back_marking == E) { --v2; }
         else if (back_marking == W) { --v1; } 
         if (front_marking == E) { ++v2; }
@@ -338,7 +331,11 @@ class Positive_crossing {
    */
   void delta_3_(D_module& new_d_module, const D_module& old_d_module) const {
     for (const auto& front_coef : old_d_module.coef_bundles()) {
+      const Local_weights_ front_weights =
+        get_local_weights_(front_coef, old_d_module);
       for (const auto& back_coef : old_d_module.others_to_source(front_coef)) {
+        const Local_weights_ back_weights =
+          get_local_weights_(back_coef, old_d_module);
         for (const Gen_type front_marking : {N, E, S, W}) {
           if (
             !extendable_(old_d_module.target_idem(front_coef), front_marking)
@@ -347,9 +344,7 @@ class Positive_crossing {
           }
           // check if I need this
           //if (!extendable_(back_alg_el.source_idem(), S)) { continue; }
-          if (
-            !coef_exists_(back_coef, front_coef, front_marking, old_d_module)
-          ) {
+          if (!coef_exists_(back_weights, front_weights, front_marking)) {
             continue;
           }
           
@@ -363,12 +358,11 @@ class Positive_crossing {
           
           /* Calculate new algebra element */
           auto concat_coef = old_d_module.concatenate(back_coef, front_coef);
-          auto new_U_weights = old_d_module.U_weights(concat_coef);
-          int a1, a2, u1, u2, b1, b2, v1, v2;
-          std::tie(a1, a2, u1, u2) =
-            get_local_weights_(back_coef, old_d_module);
-          std::tie(b1, b2, v1, v2) =
-            get_local_weights_(front_coef, old_d_module);
+          U_weights_type new_U_weights = old_d_module.U_weights(concat_coef);
+          const int a1 = back_weights.a1, a2 = back_weights.a2;
+          const int u1 = back_weights.u1, u2 = back_weights.u2;
+          const int b1 = front_weights.a1, b2 = front_weights.a2;
+          const int v1 = front_weights.u1, v2 = front_weights.u2;
           int w1 = 2 * u1 + 2 * v1 + std::abs(a1) + std::abs(b1) - 1;
           int w2 = 2 * u2 + 2 * v2 + std::abs(a2) + std::abs(b2) - 1;
           if (front_marking == E) { ++w2; } // extra weight for L_2
@@ -395,98 +389,81 @@ class Positive_crossing {
   
   /* Auxiliary functions */
     
+  /* Local LR weights and U weights of a coefficient, with the pre-hash index
+   * of the look-back table. The DA-bimodule for a crossing depends on these
+   * local weights.
+   */
+  struct Local_weights_ {
+    int a1;  // will only take values in [-1, 1]
+    int a2;  // will only take values in [-1, 1]
+    int u1;
+    int u2;
+    int pre_hash_index;
+  };
+  
   /* Adapted from ComputeHFKv2/Utility.cpp, LeftRight.
    * For \delta_2 and \delta_3. 
-   * Get local LR weights and U weights. This is because the DA-bimodule for a
-   * crossing depends on these local weights.
    * 
-   * I factored this out, but this means it gets called more than strictly
-   * necessary.
+   * The LR weight a1 is the difference of the numbers of occupied positions
+   * up to position_ in the source and target idempotents, which short
+   * idempotents count with a popcount. Callers compute the local weights of a
+   * coefficient once, before looping over markings and neighbors.
    */
-  std::tuple< int, int, int, int > get_local_weights_(
-    Coef_bundle coef,
+  Local_weights_ get_local_weights_(
+    const Coef_bundle& coef,
     const D_module& old_d_module
   ) const {
     const Idem& source_idem = old_d_module.source_idem(coef);
     const Idem& target_idem = old_d_module.target_idem(coef);
-    int a1 = 0;  // will only take values in [-1, 1]
-    int a2 = 0;  // will only take values in [-1, 1]
-    int i = 0;
-    for ( ; i <= position_; ++i) {
-      a1 = a1 + source_idem[i] - target_idem[i];
-    }
-    a2 = a1 + source_idem[i] - target_idem[i];  // i = position_ + 1
-    return std::make_tuple(
-      a1,
-      a2,
-      old_d_module.U_weight(coef, position_),
-      old_d_module.U_weight(coef, position_ + 1)
+    Local_weights_ local_weights;
+    local_weights.a1 = source_idem.count(position_ + 1) - target_idem.count(position_ + 1);
+    local_weights.a2 = local_weights.a1 + source_idem[position_ + 1] - target_idem[position_ + 1];
+    local_weights.u1 = old_d_module.U_weight(coef, position_);
+    local_weights.u2 = old_d_module.U_weight(coef, position_ + 1);
+    local_weights.pre_hash_index = Tables::pre_hash_index(
+      local_weights.a1,
+      local_weights.a2,
+      local_weights.u1,
+      local_weights.u2
     );
+    return local_weights;
   }  // get_local_weights_
   
   /* For \delta_3
    *
-   * We follow [OzsvathSzabo2018, Lemma 5.5]. Given a front marking Y, we
-   * compute the mid marking I(b, Y), the front marking I(a, I(b, Y)), and the
-   * product marking I(ab, Y).
+   * The decision only depends on the local weights of the back and front
+   * coefficients, the front marking, and the sign of the difference of local
+   * U weights of the product, and is precomputed in Crossing_tables. Some
+   * coefficients also need some U weights to be zero.
    */
   bool coef_exists_(
-    const Coef_bundle& back_coef,
-    const Coef_bundle& front_coef,
-    const Gen_type front_marking,
-    const D_module& old_d_module
+    const Local_weights_& back_weights,
+    const Local_weights_& front_weights,
+    const Gen_type front_marking
   ) const {
-    if (front_marking == S) { return false; }  // front cannot be S
-    
-    int hash_index;
-    int a1, a2, u1, u2, b1, b2, v1, v2;  // local weights
-    std::tie(a1, a2, u1, u2) = get_local_weights_(back_coef, old_d_module);
-    std::tie(b1, b2, v1, v2) = get_local_weights_(front_coef, old_d_module);
-    
-    hash_index = hash_index_(b1, b2, v1, v2, front_marking);
-    Gen_type mid_marking = positive_look_back_[hash_index];
-    if (mid_marking == null_NEW) { return false; }  // check that mid isn't null
+    const int a1 = back_weights.a1, a2 = back_weights.a2;
+    const int u1 = back_weights.u1, u2 = back_weights.u2;
+    const int b1 = front_weights.a1, b2 = front_weights.a2;
+    const int v1 = front_weights.u1, v2 = front_weights.u2;
     
-    hash_index = hash_index_(a1, a2, u1, u2, mid_marking);
-    Gen_type back_marking = positive_look_back_[hash_index];
-    
-    hash_index = hash_index_(
-      a1 + b1,
-      a2 + b2,
+    const int product_U_diff = Tables::U_diff_index(
       u1 + v1 + (std::abs(a1) + std::abs(b1)) / 2,
-      u2 + v2 + (std::abs(a2) + std::abs(b2)) / 2,
-      front_marking
+      u2 + v2 + (std::abs(a2) + std::abs(b2)) / 2
     );
-    Gen_type product_marking = positive_look_back_[hash_index];
-    // check that back is not equal to product
-    if (back_marking == product_marking) { return false; }
-    
-    /* If product marking is null, we either have (R_1, R_2U_2^t) for E
-     * or (L_2, L_1U_1^n) for W. We exclude all other cases.
-     * TO DO: Understand why this is here.
-     */
-    if (
-      product_marking == null_NEW
-      and front_marking == E
-      and !(
-        a1 == 1 and a2 == 0 and u1 == 0 and u2 == 0
-        and b1 == 0 and b2 == 1 and v1 == 0
-      )
-    ) {
-      return false;
-    }
-    else if (
-      product_marking == null_NEW
-      and front_marking == W
-      and !(
-        a1 == 0 and a2 == -1 and u1 == 0 and u2 == 0
-        and b1 == -1 and b2 == 0 and v2 == 0
+    switch (
+      Tables::delta_3_decision(
+        back_weights.pre_hash_index,
+        front_weights.pre_hash_index,
+        front_marking,
+        product_U_diff
       )
     ) {
-      return false;
+      case Tables::coef: return true;
+      case Tables::coef_if_E_weights_zero: return u1 == 0 and u2 == 0 and v1 == 0;
+      case Tables::coef_if_W_weights_zero: return u1 == 0 and u2 == 0 and v2 == 0;
+      default: return false;
     }
-    return true;
-  }  // back_marking_exists_
+  }  // coef_exists_
     
   /* Taken from ComputeHFKv2/Crossing.cpp, Extendable */
   bool extendable_(const Idem& idem, const Gen_type marking) const {
@@ -512,120 +489,7 @@ class Positive_crossing {
     return idem;  // including cases N, S
   }
   
-  /* Static methods for reasons */
-  
-  static Table make_positive_look_back_() {
-    Table table;
-    boost::mpl::for_each< boost::mpl::vector_c< int, -1, 0, 1 > >(
-      [&table](int a1) {
-        boost::mpl::for_each< boost::mpl::vector_c< int, -1, 0, 1 > >(
-          [=, &table](int a2) {
-            boost::mpl::for_each< boost::mpl::vector_c< int, -1, 0, 1 > >(
-              [=, &table](int u1) {
-                boost::mpl::for_each< boost::mpl::vector_c< int, N, E, S, W > >(
-                  [=, &table](int x) {
-                    table.set_value(
-                      hash_index_(a1, a2, u1, 0, x),
-                      D2PHSEM_(a1, a2, u1, 0, x)
-                    );
-                  }
-                );
-              }
-            );
-          }
-        );
-      }
-    );
-    return table;
-  }
-   
-  /* Auxiliary functions */
-  
-  /* Make a hash index for the data (local LR weight, local U weight, marking).
-   *
-   * Each index is unique, except when (a1, a2) = (1, -1) or (-1, 1), in which
-   * case they share an index
-   *
-   * a1 a2 i_local_LR
-   *  0  0     4
-   *  0  1     1
-   *  0 -1     7
-   *  1  0     5
-   *  1  1     3
-   *  1 -1     0
-   * -1  0     3
-   * -1  1     0
-   * -1 -1     6
-   *
-   * The result is an integer between 0 and 127.
-   */
-  static int hash_index_(int a1, int a2, int u1, int u2, int marking) {
-    return pre_hash_index_(a1, a2, u1, u2) + (marking << 0);
-  }
-  
-  static int pre_hash_index_(int a1, int a2, int u1, int u2) {
-    int i_local_LR = 4 + a1 - (3 * a2);
-    // mod 8. Not strictly necessary after creation of the table
-    i_local_LR = i_local_LR & 7;
-    
-    int i_U_diff;  // sign of u1 - u2, with 3 = negative
-    if (u1 > u2) i_U_diff = 1;
-    else if (u1 < u2) i_U_diff = 3;
-    else i_U_diff = 0;
-    
-    return (i_local_LR << 4) + (i_U_diff << 2);
-  }
-  
-  /* \delta_2 positive horizontal source edge marking.
-   *
-   * Adapted from ComputeHFKv2/Crossing.cpp, LookBack.
-   *
-   * Given the marking of a horizontal target edge with local LR weight and U
-   * weight, return the marking of the horizontal source edge.
-   */
-  static int D2PHSEM_(int a1, int a2, int u1, int u2, int marking) {
-    if (marking == N) {
-      if      (             a1 == a2             ) return N;  // 1, L_1L_2, R_2R_1
-      else if (a1 ==  1 and a2 ==  0 and u1 <  u2) return E;  // R_1U_2
-      else if (a1 ==  1 and a2 ==  0 and u1 >= u2) return W;  // R_1
-      else if (a1 ==  0 and a2 == -1 and u1 <= u2) return E;  // L_2
-      else if (a1 ==  0 and a2 == -1 and u1 >  u2) return W;  // L_2U_1
-      return null_NEW;
-    }
-    
-    else if (marking == E) {
-      if      (a1 ==  0 and a2 ==  0 and u1 <= u2) return E;  // 1
-      else if (a1 ==  0 and a2 ==  0 and u1 >  u2) return W;  // U1
-      else if (a1 == -1 and a2 ==  0             ) return N;  // L_1
-      else if (a1 ==  0 and a2 ==  1             ) return N;  // R_2
-      return null_NEW;
-    }
-    
-    else if (marking == W) {
-      if      (a1 ==  0 and a2 ==  0 and u1 <  u2) return E;  // U2
-      else if (a1 ==  0 and a2 ==  0 and u1 >= u2) return W;  // 1
-      else if (a1 == -1 and a2 ==  0             ) return N;  // L_1
-      else if (a1 ==  0 and a2 ==  1             ) return N;  // R_2
-      return null_NEW;
-    }
-    
-    else if (marking == S) {
-      if      (             u1 == u2             ) return S;  // 1
-      return null_S;
-    }
-    
-    return null;  // this should never happen
-  }
-  
   int position_;
-  
-  static const Table positive_look_back_;
 };
 
-// Instantiate the static lookup table
-template< class D_module, class Morse_event_options >
-const typename Positive_crossing< D_module, Morse_event_options >::Table
-  Positive_crossing< D_module, Morse_event_options >::positive_look_back_ =
-    Positive_crossing< D_module, Morse_event_options >::make_positive_look_back_();
-
 #endif  // POSITIVE_CROSSING_H_
\ No newline at end of file
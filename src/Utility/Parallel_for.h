@@ -0,0 +1,71 @@
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *\
+ *                                                                           *
+ *  Bundled HFK - a knot Floer homology calculator                           *
+ *                                                                           *
+ *  Copyright (C) 2021-2022  Isaac Ren                                       *
+ *  For further details, contact Isaac Ren (gopi3.1415@gmail.com).           *
+ *                                                                           *
+ *  This program is free software: you can redistribute it and/or modify     *
+ *  it under the terms of the GNU General Public License as published by     *
+ *  the Free Software Foundation, either version 3 of the License, or        *
+ *  (at your option) any later version.                                      *
+ *                                                                           *
+ *  This program is distributed in the hope that it will be useful,          *
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of           *
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the            *
+ *  GNU General Public License for more details.                             *
+ *                                                                           *
+ *  You should have received a copy of the GNU General Public License        *
+ *  along with this program.  If not, see <https://www.gnu.org/licenses/>.   *
+ *                                                                           *
+\* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+
+#ifndef PARALLEL_FOR_H_
+#define PARALLEL_FOR_H_
+
+#include <algorithm>  // min
+#include <thread>
+#include <vector>
+
+/* Parallel for.
+ * 
+ * Call f(i) for every i from 0 to n - 1, on at most n_threads threads,
+ * including the calling thread. Thread k handles the indices congruent to k
+ * modulo the number of threads, so the work done by each call of f must not
+ * depend on the thread. Return when every call is done.
+ * 
+ * Threads are created at each call, so this is only worth it for enough work.
+ */
+template< class Function >
+void parallel_for(int n, int n_threads, Function f) {
+  n_threads = std::min(n_threads, n);
+  if (n_threads <= 1) {
+    for (int i = 0; i < n; ++i) {
+      f(i);
+    }
+    return;
+  }
+  
+  auto strided = [&](int k) {
+    for (int i = k; i < n; i += n_threads) {
+      f(i);
+    }
+  };
+  
+  std::vector< std::thread > threads;
+  for (int k = 1; k < n_threads; ++k) {
+    threads.emplace_back(strided, k);
+  }
+  strided(0);
+  for (auto& thread : threads) {
+    thread.join();
+  }
+}
+
+/* Number of threads to use by default. */
+inline int default_n_threads() {
+  const int n_threads = std::thread::hardware_concurrency();
+  return n_threads > 0 ? n_threads : 1;
+}
+
+#endif  // PARALLEL_FOR_H_
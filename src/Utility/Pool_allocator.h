@@ -0,0 +1,209 @@
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *\
+ *                                                                           *
+ *  Bundled HFK - a knot Floer homology calculator                           *
+ *                                                                           *
+ *  Copyright (C) 2021-2022  Isaac Ren                                       *
+ *  For further details, contact Isaac Ren (gopi3.1415@gmail.com).           *
+ *                                                                           *
+ *  This program is free software: you can redistribute it and/or modify     *
+ *  it under the terms of the GNU General Public License as published by     *
+ *  the Free Software Foundation, either version 3 of the License, or        *
+ *  (at your option) any later version.                                      *
+ *                                                                           *
+ *  This program is distributed in the hope that it will be useful,          *
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of           *
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the            *
+ *  GNU General Public License for more details.                             *
+ *                                                                           *
+ *  You should have received a copy of the GNU General Public License        *
+ *  along with this program.  If not, see <https://www.gnu.org/licenses/>.   *
+ *                                                                           *
+\* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+
+#ifndef POOL_ALLOCATOR_H_
+#define POOL_ALLOCATOR_H_
+
+#include <cstddef>  // max_align_t, ptrdiff_t, size_t
+#include <memory>  // make_shared, shared_ptr
+#include <new>  // operator new, operator delete
+#include <type_traits>  // false_type, true_type
+#include <vector>
+
+/* Node pool.
+ * 
+ * Hands out blocks of a single size, taken from chunks of increasing size.
+ * Freed blocks go to a free list and are reused by later allocations. Memory
+ * goes back to the system only when the pool is destroyed.
+ * 
+ * The block size is fixed by the first allocation. Node-based containers
+ * only allocate blocks of one size, so other sizes are simply forwarded to
+ * operator new.
+ */
+class Node_pool {
+ public:
+  Node_pool() :
+    block_size_(0),
+    free_list_(nullptr),
+    next_chunk_size_(64)
+  { }
+  
+  Node_pool(const Node_pool&) = delete;
+  Node_pool& operator=(const Node_pool&) = delete;
+  
+  ~Node_pool() {
+    for (void* chunk : chunks_) {
+      ::operator delete(chunk);
+    }
+  }
+  
+  void* allocate(std::size_t size) {
+    if (block_size_ == 0) {
+      block_size_ = round_up_(size);
+    }
+    if (round_up_(size) != block_size_) {
+      return ::operator new(size);
+    }
+    if (free_list_ == nullptr) {
+      add_chunk_();
+    }
+    Free_block_* block = free_list_;
+    free_list_ = block->next;
+    return block;
+  }
+  
+  void deallocate(void* pointer, std::size_t size) {
+    if (round_up_(size) != block_size_) {
+      ::operator delete(pointer);
+      return;
+    }
+    Free_block_* block = static_cast< Free_block_* >(pointer);
+    block->next = free_list_;
+    free_list_ = block;
+  }
+ 
+ private:
+  struct Free_block_ {
+    Free_block_* next;
+  };
+  
+  static std::size_t round_up_(std::size_t size) {
+    const std::size_t alignment = alignof(std::max_align_t);
+    if (size < sizeof(Free_block_)) {
+      size = sizeof(Free_block_);
+    }
+    return (size + alignment - 1) / alignment * alignment;
+  }
+  
+  /* Chunks double in size, up to a limit, so small containers stay small. */
+  void add_chunk_() {
+    char* chunk = static_cast< char* >(::operator new(next_chunk_size_ * block_size_));
+    chunks_.push_back(chunk);
+    for (std::size_t i = next_chunk_size_; i-- > 0; ) {
+      Free_block_* block = reinterpret_cast< Free_block_* >(chunk + i * block_size_);
+      block->next = free_list_;
+      free_list_ = block;
+    }
+    if (next_chunk_size_ < 65536) {
+      next_chunk_size_ *= 2;
+    }
+  }
+  
+  std::size_t block_size_;
+  Free_block_* free_list_;
+  std::size_t next_chunk_size_;
+  std::vector< void* > chunks_;
+};
+
+/* Pool allocator.
+ * 
+ * Standard allocator interface on top of a node pool, with one pool per
+ * container:
+ * - a default-constructed allocator creates a new pool;
+ * - copies of an allocator, including rebound copies, share its pool, so that
+ * the nodes of a container all come from the same pool;
+ * - copying a container creates a new pool for the copy (see
+ * select_on_container_copy_construction), and copy assignment keeps the pool
+ * of the assigned container;
+ * - move assignment and swap hand the pool over with the elements. A
+ * moved-from container still refers to the pool, which is freed when the last
+ * container using it is destroyed.
+ * 
+ * The pool is not thread-safe: containers that share a pool, such as a
+ * container and the one it was moved from, must be used from one thread at a
+ * time.
+ */
+template< class T >
+class Pool_allocator {
+ public:
+  using value_type = T;
+  using pointer = T*;
+  using const_pointer = const T*;
+  using reference = T&;
+  using const_reference = const T&;
+  using size_type = std::size_t;
+  using difference_type = std::ptrdiff_t;
+  
+  template< class U >
+  struct rebind {
+    using other = Pool_allocator< U >;
+  };
+  
+  // The pool follows the elements when containers are moved or swapped
+  using propagate_on_container_copy_assignment = std::false_type;
+  using propagate_on_container_move_assignment = std::true_type;
+  using propagate_on_container_swap = std::true_type;
+  
+  Pool_allocator() :
+    pool_(std::make_shared< Node_pool >())
+  { }
+  
+  /* Declared so that moving an allocator copies it: allocators must stay
+   * usable after a move, and a moved-from container still deallocates its
+   * header node.
+   */
+  Pool_allocator(const Pool_allocator&) = default;
+  Pool_allocator& operator=(const Pool_allocator&) = default;
+  
+  template< class U >
+  Pool_allocator(const Pool_allocator< U >& other) :
+    pool_(other.pool_)
+  { }
+  
+  Pool_allocator select_on_container_copy_construction() const {
+    return Pool_allocator();
+  }
+  
+  T* allocate(std::size_t n) {
+    if (n == 1) {
+      return static_cast< T* >(pool_->allocate(sizeof(T)));
+    }
+    return static_cast< T* >(::operator new(n * sizeof(T)));
+  }
+  
+  void deallocate(T* pointer, std::size_t n) {
+    if (n == 1) {
+      pool_->deallocate(pointer, sizeof(T));
+    }
+    else {
+      ::operator delete(pointer);
+    }
+  }
+  
+  template< class U >
+  bool operator==(const Pool_allocator< U >& other) const {
+    return pool_ == other.pool_;
+  }
+  
+  template< class U >
+  bool operator!=(const Pool_allocator< U >& other) const {
+    return pool_ != other.pool_;
+  }
+ 
+ private:
+  template< class U >
+  friend class Pool_allocator;
+  
+  std::shared_ptr< Node_pool > pool_;
+};
+
+#endif  // POOL_ALLOCATOR_H_